@@ -1,31 +1,15 @@
-QT       += core gui
+# Builds the palette engine library first, then the GUI, the spi command
+# line tool and the tests that link it.
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+TEMPLATE = subdirs
 
-CONFIG += c++11
+SUBDIRS = \
+    core \
+    cli \
+    gui \
+    tests
 
-# You can make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
-
-SOURCES += \
-    main.cpp \
-    mainwindow.cpp
-
-HEADERS += \
-    mainwindow.h
-
-FORMS += \
-    mainwindow.ui
-
-TRANSLATIONS += \
-    SNES_Palette_Imager_en_US.ts
-CONFIG += lrelease
-CONFIG += embed_translations
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
-
-RC_ICONS = icon.ico
\ No newline at end of file
+cli.file = cli/spi.pro
+cli.depends = core
+gui.depends = core
+tests.depends = core
@@ -0,0 +1,668 @@
+#include "jobrunner.h"
+
+#include <QFile>
+#include <QProcess>
+
+#include "importmanifest.h"
+#include "paletteindex.h"
+#include "palettescanner.h"
+#include "romdiff.h"
+
+static bool parseMapMode(const QString &name, AddressMapMode &mode)
+{
+    static const QStringList names = { "none", "lorom", "hirom", "exlorom", "exhirom", "sa1", "sdd1" };
+    int index = names.indexOf(name.toLower().remove('-'));
+
+    if (index < 0)
+    {
+        return false;
+    }
+
+    mode = AddressMapMode(index);
+    return true;
+}
+
+
+
+static bool parseQuantization(const QString &name, ColorQuantization &mode)
+{
+    static const QStringList names = { "truncate", "round", "dither", "oklab" };
+    int index = names.indexOf(name.toLower());
+
+    if (index < 0)
+    {
+        return false;
+    }
+
+    mode = ColorQuantization(index);
+    return true;
+}
+
+
+
+JobRunner::JobRunner(QTextStream &outputStream, QTextStream &errorStream)
+    : out(outputStream)
+    , err(errorStream)
+    , failures(0)
+    , bookmarksOpen(false)
+{
+}
+
+
+
+int JobRunner::failedJobs() const
+{
+    return failures;
+}
+
+
+
+bool JobRunner::fail(const QString &message)
+{
+    err << "ERROR: " << message << Qt::endl;
+    failures++;
+    return false;
+}
+
+
+
+bool JobRunner::openRom(const QString &romPath, const QStringList &patchPaths)
+{
+    if (!engine.openRom(romPath, patchPaths))
+    {
+        return fail(romPath + ": " + engine.errorString());
+    }
+
+    return true;
+}
+
+
+
+bool JobRunner::openBookmarks()
+{
+    if (!bookmarksOpen)
+    {
+        QString bookmarkError;
+
+        if (!bookmarkIndex.open(BookmarkIndex::defaultPath(), bookmarkError))
+        {
+            return fail("bookmarks: " + bookmarkError);
+        }
+
+        bookmarksOpen = true;
+    }
+
+    return true;
+}
+
+
+
+bool JobRunner::parseSettings(const QStringList &arguments, PaletteSettings &settings)
+{
+    if (arguments.size() < 4)
+    {
+        return fail(arguments.first() + ": expected <address> <colorCount> <rowWidth>.");
+    }
+
+    bool countOK;
+    bool widthOK;
+
+    if (!AddressMapper::parseAddress(arguments.at(1), settings.address, settings.busAddress))
+    {
+        return fail(arguments.first() + ": invalid address \"" + arguments.at(1) + "\".");
+    }
+
+    settings.colorCount = arguments.at(2).toUInt(&countOK);
+    settings.rowWidth = arguments.at(3).toUInt(&widthOK);
+
+    if (!countOK || !widthOK || settings.colorCount == 0 || settings.rowWidth == 0)
+    {
+        return fail(arguments.first() + ": invalid color count or row width.");
+    }
+
+    return true;
+}
+
+
+
+bool JobRunner::runJob(const QStringList &arguments)
+{
+    if (arguments.isEmpty())
+    {
+        return true;
+    }
+
+    const QString command = arguments.first();
+
+    if (command == "open")
+    {
+        if (arguments.size() < 2)
+        {
+            return fail("open: expected <rom> [patch...].");
+        }
+
+        return openRom(arguments.at(1), arguments.mid(2));
+    }
+
+    if (!engine.isLoaded())
+    {
+        return fail(command + ": No ROM loaded.");
+    }
+
+    bool ok = false;
+
+    if (command == "save")
+    {
+        ok = engine.saveRom();
+    }
+    else if (command == "map")
+    {
+        AddressMapMode mode;
+
+        if (arguments.size() != 2 || !parseMapMode(arguments.at(1), mode))
+        {
+            return fail("map: expected none|lorom|hirom|exlorom|exhirom|sa1|sdd1.");
+        }
+
+        engine.setAddressMapMode(mode);
+        return true;
+    }
+    else if (command == "quantize")
+    {
+        ColorQuantization mode;
+
+        if (arguments.size() != 2 || !parseQuantization(arguments.at(1), mode))
+        {
+            return fail("quantize: expected truncate|round|dither|oklab.");
+        }
+
+        engine.setColorQuantization(mode);
+        return true;
+    }
+    else if (command == "checksum")
+    {
+        if (arguments.size() == 2 && (arguments.at(1) == "on" || arguments.at(1) == "off"))
+        {
+            engine.setChecksumUpdate(arguments.at(1) == "on");
+            return true;
+        }
+
+        quint16 stored;
+        quint16 computed;
+
+        if (arguments.size() != 1)
+        {
+            return fail("checksum: expected [on|off].");
+        }
+
+        if (!engine.headerChecksum(stored, computed))
+        {
+            return fail("checksum: No internal header for the current map mode.");
+        }
+
+        out << "stored " << QString::number(stored, 16).rightJustified(4, '0')
+            << " computed " << QString::number(computed, 16).rightJustified(4, '0')
+            << (stored == computed ? " ok" : " stale") << Qt::endl;
+        return true;
+    }
+    else if (command == "save-as")
+    {
+        if (arguments.size() != 2)
+        {
+            return fail("save-as: expected <rom>.");
+        }
+
+        ok = engine.saveRomAs(arguments.at(1));
+    }
+    else if (command == "export-patch")
+    {
+        if (arguments.size() != 2)
+        {
+            return fail("export-patch: expected <file.ips|file.bps>.");
+        }
+
+        ok = engine.exportPatch(arguments.at(1), RomPatch::formatForPath(arguments.at(1)));
+    }
+    else if (command == "extract")
+    {
+        PaletteSettings settings;
+
+        if (!parseSettings(arguments, settings))
+        {
+            return false;
+        }
+
+        ok = engine.extractPalette(settings, arguments.size() > 4 ? arguments.at(4) : QString());
+    }
+    else if (command == "extract-range")
+    {
+        PaletteSettings settings;
+        QList<PaletteSettings> paletteList;
+        quint32 endAddress;
+        bool endBusAddress;
+        int extracted;
+
+        if (!parseSettings(arguments, settings))
+        {
+            return false;
+        }
+
+        if (arguments.size() < 5 || arguments.size() > 6 || !AddressMapper::parseAddress(arguments.at(4), endAddress, endBusAddress))
+        {
+            return fail("extract-range: expected <address> <colorCount> <rowWidth> <endAddress> [directory].");
+        }
+
+        ok = engine.paletteRange(settings, endAddress, paletteList)
+             && engine.extractPalettes(paletteList, arguments.size() > 5 ? arguments.at(5) : QString(), extracted);
+
+        if (ok)
+        {
+            out << "Extracted " << extracted << " palettes." << Qt::endl;
+        }
+    }
+    else if (command == "extract-list")
+    {
+        QList<PaletteSettings> paletteList;
+        bool countOK;
+        bool widthOK;
+        int extracted;
+
+        if (arguments.size() < 4 || arguments.size() > 5)
+        {
+            return fail("extract-list: expected <colorCount> <rowWidth> <addressFile> [directory].");
+        }
+
+        PaletteSettings settings;
+        settings.colorCount = arguments.at(1).toUInt(&countOK);
+        settings.rowWidth = arguments.at(2).toUInt(&widthOK);
+
+        if (!countOK || !widthOK || settings.colorCount == 0 || settings.rowWidth == 0)
+        {
+            return fail("extract-list: invalid color count or row width.");
+        }
+
+        QFile addressFile(arguments.at(3));
+
+        if (!addressFile.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            return fail("extract-list: Failed to open address file.");
+        }
+
+        QTextStream addressStream(&addressFile);
+
+        while (!addressStream.atEnd())
+        {
+            QString line = addressStream.readLine().trimmed();
+
+            if (line.isEmpty() || line.startsWith("#"))
+            {
+                continue;
+            }
+
+            if (!AddressMapper::parseAddress(line, settings.address, settings.busAddress))
+            {
+                return fail("extract-list: invalid address \"" + line + "\".");
+            }
+
+            paletteList.append(settings);
+        }
+
+        ok = engine.extractPalettes(paletteList, arguments.size() > 4 ? arguments.at(4) : QString(), extracted);
+
+        if (ok)
+        {
+            out << "Extracted " << extracted << " palettes." << Qt::endl;
+        }
+    }
+    else if (command == "import-manifest")
+    {
+        if (arguments.size() != 2)
+        {
+            return fail("import-manifest: expected <manifest>.");
+        }
+
+        QList<ManifestEntry> entries;
+        QString manifestError;
+
+        if (!ImportManifest::load(arguments.at(1), entries, manifestError))
+        {
+            return fail("import-manifest: " + manifestError);
+        }
+
+        ok = engine.importManifest(entries);
+    }
+    else if (command == "import-sheet")
+    {
+        PaletteSettings settings;
+        bool countOK;
+
+        if (arguments.size() != 4 || !AddressMapper::parseAddress(arguments.at(1), settings.address, settings.busAddress))
+        {
+            return fail("import-sheet: expected <address> <subPaletteCount> <file>.");
+        }
+
+        quint32 subPaletteCount = arguments.at(2).toUInt(&countOK);
+
+        if (!countOK)
+        {
+            return fail("import-sheet: invalid sub-palette count.");
+        }
+
+        ok = engine.importTiledImage(arguments.at(3), settings, subPaletteCount);
+    }
+    else if (command == "find")
+    {
+        if (arguments.size() != 2)
+        {
+            return fail("find: expected <cgram|bin|pal|png>.");
+        }
+
+        QString loadError;
+        QList<PaletteQuery> queries = PaletteIndex::loadQueries(arguments.at(1), loadError);
+
+        if (queries.isEmpty())
+        {
+            return fail("find: " + loadError);
+        }
+
+        for (const PaletteMatch &match : engine.findPalettes(queries))
+        {
+            quint32 busAddress;
+            out << queries.at(match.query).name << " 0x" << QString::number(match.address, 16).rightJustified(6, '0');
+
+            if (engine.addressMapMode() != AddressMapMode::None && engine.toBusAddress(match.address, busAddress))
+            {
+                out << " $" << QString::number(busAddress, 16).rightJustified(6, '0');
+            }
+
+            out << Qt::endl;
+        }
+
+        return true;
+    }
+    else if (command == "find-similar")
+    {
+        FuzzySearchOptions options;
+
+        if (arguments.size() < 2 || arguments.size() > 4)
+        {
+            return fail("find-similar: expected <image> [tolerance] [maxResults].");
+        }
+
+        if (arguments.size() > 2)
+        {
+            options.tolerance = arguments.at(2).toInt();
+        }
+
+        if (arguments.size() > 3)
+        {
+            options.maxResults = arguments.at(3).toInt();
+        }
+
+        QImage screenshot(arguments.at(1));
+
+        if (screenshot.isNull())
+        {
+            return fail("find-similar: Failed to open image file.");
+        }
+
+        if (options.tolerance < 0 || options.maxResults <= 0)
+        {
+            return fail("find-similar: invalid tolerance or result limit.");
+        }
+
+        const QList<quint16> colors = PaletteScanner::referenceColors(screenshot, options.minimumPixelCount);
+        const QByteArrayView romData = engine.storage().view(0, engine.size());
+
+        for (const PaletteCandidate &candidate : PaletteScanner::findSimilar(romData, colors, options))
+        {
+            quint32 busAddress;
+            out << "0x" << QString::number(candidate.address, 16).rightJustified(6, '0');
+
+            if (engine.addressMapMode() != AddressMapMode::None && engine.toBusAddress(candidate.address, busAddress))
+            {
+                out << " $" << QString::number(busAddress, 16).rightJustified(6, '0');
+            }
+
+            out << " " << QString::number(candidate.score, 'f', 3) << Qt::endl;
+        }
+
+        return true;
+    }
+    else if (command == "bookmark")
+    {
+        PaletteSettings settings;
+        PaletteBookmark bookmark;
+        QString bookmarkError;
+
+        if (arguments.size() < 5 || arguments.size() > 6)
+        {
+            return fail("bookmark: expected <address> <colorCount> <rowWidth> <name> [image|pal|bin].");
+        }
+
+        if (!parseSettings(arguments, settings) || !openBookmarks())
+        {
+            return false;
+        }
+
+        bookmark.name = arguments.at(4);
+        bookmark.settings = settings;
+
+        if (arguments.size() > 5)
+        {
+            const int format = QStringList({ "image", "pal", "bin" }).indexOf(arguments.at(5));
+
+            if (format < 0)
+            {
+                return fail("bookmark: expected image, pal or bin as the format.");
+            }
+
+            bookmark.format = PaletteFileFormat(format);
+        }
+
+        if (!bookmarkIndex.addBookmark(engine.fingerprint(), bookmark, bookmarkError))
+        {
+            return fail("bookmark: " + bookmarkError);
+        }
+
+        return true;
+    }
+    else if (command == "bookmarks")
+    {
+        static const char *formatNames[] = { "image", "pal", "bin" };
+        const QString filter = arguments.mid(1).join(' ');
+
+        if (!openBookmarks())
+        {
+            return false;
+        }
+
+        for (const PaletteBookmark &bookmark : bookmarkIndex.bookmarks(engine.fingerprint()))
+        {
+            const PaletteSettings &settings = bookmark.settings;
+            const QString addressText = (settings.busAddress ? "$" : "0x") + QString::number(settings.address, 16).rightJustified(6, '0');
+
+            if (!filter.isEmpty() && !bookmark.name.contains(filter, Qt::CaseInsensitive) && !addressText.contains(filter, Qt::CaseInsensitive))
+            {
+                continue;
+            }
+
+            out << addressText << " " << settings.colorCount << " " << settings.rowWidth << " "
+                << formatNames[int(bookmark.format)] << " " << bookmark.name << Qt::endl;
+        }
+
+        return true;
+    }
+    else if (command == "diff")
+    {
+        if (arguments.size() < 2 || arguments.size() > 3)
+        {
+            return fail("diff: expected <otherRom> [report.csv].");
+        }
+
+        RomStorage otherRom;
+
+        if (!otherRom.open(arguments.at(1)))
+        {
+            return fail("diff: " + otherRom.errorString());
+        }
+
+        const QByteArrayView before = otherRom.view(0, otherRom.size());
+        const QByteArrayView after = engine.storage().view(0, engine.size());
+        const QList<RomDiffRange> ranges = RomDiff::compare(before, after);
+
+        if (arguments.size() > 2)
+        {
+            QFile reportFile(arguments.at(2));
+            QString reportError;
+
+            if (!reportFile.open(QIODevice::WriteOnly | QIODevice::Text))
+            {
+                return fail("diff: Failed to create the report file.");
+            }
+
+            if (!RomDiff::writeReport(&reportFile, before, after, ranges, engine.addressMapper(), reportError))
+            {
+                return fail("diff: " + reportError);
+            }
+
+            return true;
+        }
+
+        for (const RomDiffRange &range : ranges)
+        {
+            quint32 busAddress;
+            out << "0x" << QString::number(range.offset, 16).rightJustified(6, '0');
+
+            if (engine.addressMapMode() != AddressMapMode::None && engine.toBusAddress(range.offset, busAddress))
+            {
+                out << " $" << QString::number(busAddress, 16).rightJustified(6, '0');
+            }
+
+            out << " " << range.length << (range.paletteLike ? " palette" : "") << Qt::endl;
+        }
+
+        return true;
+    }
+    else if (command == "scan")
+    {
+        PaletteScanOptions options;
+
+        if (arguments.size() > 1)
+        {
+            options.colorCount = arguments.at(1).toUInt();
+        }
+
+        if (arguments.size() > 2)
+        {
+            options.maxResults = arguments.at(2).toInt();
+        }
+
+        if (options.colorCount < 2 || options.colorCount > 256 || options.maxResults <= 0)
+        {
+            return fail("scan: invalid color count or result limit.");
+        }
+
+        const QByteArrayView romData = engine.storage().view(0, engine.size());
+
+        for (const PaletteCandidate &candidate : PaletteScanner::scan(romData, options))
+        {
+            quint32 busAddress;
+            out << "0x" << QString::number(candidate.address, 16).rightJustified(6, '0');
+
+            if (engine.addressMapMode() != AddressMapMode::None && engine.toBusAddress(candidate.address, busAddress))
+            {
+                out << " $" << QString::number(busAddress, 16).rightJustified(6, '0');
+            }
+
+            out << " " << QString::number(candidate.score, 'f', 3) << Qt::endl;
+        }
+
+        return true;
+    }
+    else
+    {
+        PaletteSettings settings;
+
+        if (!parseSettings(arguments, settings))
+        {
+            return false;
+        }
+
+        if (arguments.size() != 5)
+        {
+            return fail(command + ": expected <address> <colorCount> <rowWidth> <file>.");
+        }
+
+        const QString path = arguments.at(4);
+
+        if (command == "import-image")
+        {
+            ok = engine.importImage(path, settings, false);
+        }
+        else if (command == "import-pal")
+        {
+            ok = engine.importPal(path, settings, false);
+        }
+        else if (command == "import-bin")
+        {
+            ok = engine.importBin(path, settings, false);
+        }
+        else if (command == "export-image")
+        {
+            ok = engine.exportImage(path, settings);
+        }
+        else if (command == "export-pal")
+        {
+            ok = engine.exportPal(path, settings);
+        }
+        else if (command == "export-bin")
+        {
+            ok = engine.exportBin(path, settings);
+        }
+        else
+        {
+            return fail("Unknown command \"" + command + "\".");
+        }
+    }
+
+    if (!ok)
+    {
+        return fail(command + ": " + engine.errorString());
+    }
+
+    return true;
+}
+
+
+
+bool JobRunner::runJobFile(QIODevice *device, bool keepGoing)
+{
+    QTextStream jobStream(device);
+    int lineNumber = 0;
+    bool allOK = true;
+
+    while (!jobStream.atEnd())
+    {
+        QString line = jobStream.readLine().trimmed();
+        lineNumber++;
+
+        if (line.isEmpty() || line.startsWith("#"))
+        {
+            continue;
+        }
+
+        if (!runJob(QProcess::splitCommand(line)))
+        {
+            err << "       (line " << lineNumber << ")" << Qt::endl;
+            allOK = false;
+
+            if (!keepGoing)
+            {
+                break;
+            }
+        }
+    }
+
+    return allOK;
+}
@@ -0,0 +1,66 @@
+#ifndef JOBRUNNER_H
+#define JOBRUNNER_H
+
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+#include "bookmarkindex.h"
+#include "paletteengine.h"
+
+// Runs spi job commands against a single PaletteEngine so that one process
+// and one loaded ROM serve every job in a batch.
+//
+// Job syntax, one job per line in a job file:
+//   open <rom> [patch.ips|patch.bps...]
+//   map none|lorom|hirom|exlorom|exhirom|sa1|sdd1
+//   quantize truncate|round|dither|oklab
+//   checksum [on|off]
+//   save
+//   save-as <rom>
+//   export-patch <file.ips|file.bps>
+//   import-image|import-pal|import-bin <address> <colorCount> <rowWidth> <file>
+//   export-image|export-pal|export-bin <address> <colorCount> <rowWidth> <file>
+//   import-sheet <address> <subPaletteCount> <file>
+//   import-manifest <manifest>
+//   extract <address> <colorCount> <rowWidth> [directory]
+//   extract-range <address> <colorCount> <rowWidth> <endAddress> [directory]
+//   extract-list <colorCount> <rowWidth> <addressFile> [directory]
+//   scan [colorCount] [maxResults]
+//   find <cgram|bin|pal|png>
+//   find-similar <image> [tolerance] [maxResults]
+//   diff <otherRom> [report.csv]
+//   bookmark <address> <colorCount> <rowWidth> <name> [image|pal|bin]
+//   bookmarks [filter]
+// Addresses are hexadecimal. "0x1234" or bare hex is a file offset, while
+// "$C08000" or "C0:8000" is an SNES bus address translated through the
+// current map mode. extract-list reads one such address per line.
+// checksum prints the stored and computed header checksum; on/off sets
+// whether saving rewrites it (on by default). Bookmarks are shared with the
+// GUI and stored per ROM (see BookmarkIndex).
+class JobRunner
+{
+public:
+    JobRunner(QTextStream &outputStream, QTextStream &errorStream);
+
+    bool openRom(const QString &romPath, const QStringList &patchPaths = QStringList());
+    bool runJob(const QStringList &arguments);
+    bool runJobFile(QIODevice *device, bool keepGoing);
+
+    int failedJobs() const;
+
+private:
+    PaletteEngine engine;
+    QTextStream &out;
+    QTextStream &err;
+    int failures;
+    BookmarkIndex bookmarkIndex;
+    bool bookmarksOpen;
+
+    bool openBookmarks();
+    bool parseSettings(const QStringList &arguments, PaletteSettings &settings);
+    bool fail(const QString &message);
+};
+
+#endif // JOBRUNNER_H
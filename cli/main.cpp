@@ -0,0 +1,77 @@
+#include "jobrunner.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("spi");
+    QCoreApplication::setApplicationVersion("1.2.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Super Palette Imager batch tool.\n\n"
+                                     "Runs palette import/export/extract jobs against one loaded ROM.\n"
+                                     "Jobs come from --jobs and/or the positional arguments.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption romOption(QStringList() << "r" << "rom", "ROM to open before running jobs.", "rom");
+    QCommandLineOption patchOption(QStringList() << "p" << "patch", "Apply an IPS/BPS patch to --rom in memory (repeatable, applied in order).", "patch");
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Read jobs from <file>, one per line ('-' for stdin).", "file");
+    QCommandLineOption keepGoingOption(QStringList() << "k" << "keep-going", "Continue with the next job after a failure.");
+    parser.addOption(romOption);
+    parser.addOption(patchOption);
+    parser.addOption(jobsOption);
+    parser.addOption(keepGoingOption);
+    parser.addPositionalArgument("command", "A single job, e.g. \"extract 0x1234 16 16\".", "[command [args...]]");
+
+    parser.process(a);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    JobRunner runner(out, err);
+    bool keepGoing = parser.isSet(keepGoingOption);
+
+    if (parser.isSet(romOption) && !runner.openRom(parser.value(romOption), parser.values(patchOption)))
+    {
+        return 1;
+    }
+
+    if (parser.isSet(jobsOption))
+    {
+        QFile jobFile;
+        QString jobPath = parser.value(jobsOption);
+        bool opened;
+
+        if (jobPath == "-")
+        {
+            opened = jobFile.open(stdin, QIODevice::ReadOnly);
+        }
+        else
+        {
+            jobFile.setFileName(jobPath);
+            opened = jobFile.open(QIODevice::ReadOnly);
+        }
+
+        if (!opened)
+        {
+            err << "ERROR: Failed to open job file " << jobPath << Qt::endl;
+            return 1;
+        }
+
+        if (!runner.runJobFile(&jobFile, keepGoing) && !keepGoing)
+        {
+            return 1;
+        }
+    }
+
+    if (!parser.positionalArguments().isEmpty())
+    {
+        runner.runJob(parser.positionalArguments());
+    }
+
+    return runner.failedJobs() == 0 ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+# spi: command line front end for batch palette jobs.
+
+QT       = core gui concurrent
+
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+TARGET = spi
+
+include(../core/spicore.pri)
+
+SOURCES += \
+    main.cpp \
+    jobrunner.cpp
+
+HEADERS += \
+    jobrunner.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
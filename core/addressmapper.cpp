@@ -0,0 +1,244 @@
+#include "addressmapper.h"
+
+static const quint32 copierHeaderSize = 512;
+static const quint32 slotSize = 0x8000;
+
+
+
+AddressMapper::AddressMapper(AddressMapMode mode, qsizetype fileSize, qsizetype headerSize)
+    : mapMode(mode)
+    , header(0)
+    , romLength(0)
+{
+    if (headerSize == autoDetectHeader)
+    {
+        header = (fileSize % 1024 == copierHeaderSize) ? copierHeaderSize : 0;
+    }
+    else
+    {
+        header = quint32(qBound<qsizetype>(0, headerSize, fileSize));
+    }
+
+    romLength = quint32(qMax<qsizetype>(0, fileSize - header));
+
+    for (quint32 slot = 0; slot < 512; slot++)
+    {
+        qint64 romOffset = romOffsetForSlot(slot >> 1, slot & 1);
+        busSlotBase[slot] = (romOffset >= 0 && romOffset < romLength) ? qint32(romOffset) : -1;
+    }
+
+    quint32 romSlots = (romLength + slotSize - 1) / slotSize;
+    fileSlotBus.resize(romSlots);
+
+    for (quint32 slot = 0; slot < romSlots; slot++)
+    {
+        fileSlotBus[slot] = qint32(busAddressForRomSlot(slot * slotSize));
+    }
+}
+
+
+
+AddressMapMode AddressMapper::mode() const
+{
+    return mapMode;
+}
+
+quint32 AddressMapper::headerSize() const
+{
+    return header;
+}
+
+quint32 AddressMapper::romSize() const
+{
+    return romLength;
+}
+
+
+
+QStringList AddressMapper::modeNames()
+{
+    return QStringList() << "None" << "Lo ROM" << "Hi ROM" << "ExLo ROM" << "ExHi ROM" << "SA-1 ROM" << "SDD-1 ROM";
+}
+
+
+
+bool AddressMapper::parseAddress(QString string, quint32 &value, bool &busAddress)
+{
+    busAddress = false;
+
+    if (string.startsWith("$"))
+    {
+        string.remove(0, 1);
+        busAddress = true;
+    }
+    else if (string.startsWith("0x", Qt::CaseInsensitive))
+    {
+        string.remove(0, 2);
+    }
+
+    if (string.contains(':'))
+    {
+        string.remove(':');
+        busAddress = true;
+    }
+
+    bool convertOK;
+    value = string.toUInt(&convertOK, 16);
+    return convertOK;
+}
+
+
+
+// ROM offset (without copier header) mapped at bank:0000 or bank:8000, or
+// -1 when that half bank is not ROM in the given mode.
+qint64 AddressMapper::romOffsetForSlot(quint32 bank, bool upperHalf) const
+{
+    const quint32 half = upperHalf ? 0x8000 : 0x0000;
+    const bool wram = bank == 0x7E || bank == 0x7F;
+    const bool systemBank = (bank & 0x7F) < 0x40;
+
+    if (wram)
+    {
+        return -1;
+    }
+
+    switch (mapMode)
+    {
+    case AddressMapMode::LoRom:
+        if (upperHalf)
+        {
+            return qint64(bank & 0x7F) * slotSize;
+        }
+
+        // Banks 40-6F/C0-EF mirror the upper half into the lower one.
+        if ((bank & 0x7F) >= 0x40 && (bank & 0x7F) < 0x70)
+        {
+            return qint64(bank & 0x7F) * slotSize;
+        }
+
+        return -1;
+
+    case AddressMapMode::HiRom:
+        if (systemBank && !upperHalf)
+        {
+            return -1;
+        }
+
+        return qint64(bank & 0x3F) * 0x10000 + half;
+
+    case AddressMapMode::ExLoRom:
+        if (!upperHalf)
+        {
+            return -1;
+        }
+
+        if (bank >= 0x80)
+        {
+            return qint64(bank & 0x7F) * slotSize;
+        }
+
+        return 0x400000 + qint64(bank) * slotSize;
+
+    case AddressMapMode::ExHiRom:
+        if (systemBank && !upperHalf)
+        {
+            return -1;
+        }
+
+        return ((bank & 0x80) ? 0 : 0x400000) + qint64(bank & 0x3F) * 0x10000 + half;
+
+    case AddressMapMode::Sa1Rom:
+        // Default Super MMC setup: blocks 0-3 at 00-1F, 20-3F, 80-9F, A0-BF
+        // and the first 4 MB linearly at C0-FF.
+        if (bank >= 0xC0)
+        {
+            return qint64(bank & 0x3F) * 0x10000 + half;
+        }
+
+        if (systemBank && upperHalf)
+        {
+            return qint64((bank & 0x3F) | ((bank & 0x80) >> 1)) * slotSize;
+        }
+
+        return -1;
+
+    case AddressMapMode::Sdd1Rom:
+        if (bank >= 0xC0)
+        {
+            return qint64(bank & 0x3F) * 0x10000 + half;
+        }
+
+        if (systemBank && upperHalf)
+        {
+            return qint64(bank & 0x3F) * slotSize;
+        }
+
+        return -1;
+
+    case AddressMapMode::None:
+        break;
+    }
+
+    return -1;
+}
+
+
+
+// Preferred bus address for a 32 KB aligned ROM offset, or -1 when the
+// offset is not visible on the bus in the given mode.
+qint64 AddressMapper::busAddressForRomSlot(quint32 romOffset) const
+{
+    const quint32 slot = romOffset / slotSize;
+
+    switch (mapMode)
+    {
+    case AddressMapMode::LoRom:
+        if (slot < 0x80)
+        {
+            return (qint64(0x80 | slot) << 16) | 0x8000;
+        }
+
+        return -1;
+
+    case AddressMapMode::ExLoRom:
+        if (slot < 0x80)
+        {
+            return (qint64(0x80 | slot) << 16) | 0x8000;
+        }
+
+        if (slot < 0x80 + 0x7E)
+        {
+            return (qint64(slot - 0x80) << 16) | 0x8000;
+        }
+
+        return -1;
+
+    case AddressMapMode::ExHiRom:
+        if (romOffset >= 0x400000)
+        {
+            if (romOffset < 0x400000 + 0x3E0000)
+            {
+                return (qint64(0x40 + ((romOffset - 0x400000) >> 16)) << 16) | (romOffset & 0x8000);
+            }
+
+            return -1;
+        }
+
+        return (qint64(0xC0 | (romOffset >> 16)) << 16) | (romOffset & 0x8000);
+
+    case AddressMapMode::HiRom:
+    case AddressMapMode::Sa1Rom:
+    case AddressMapMode::Sdd1Rom:
+        if (romOffset < 0x400000)
+        {
+            return (qint64(0xC0 | (romOffset >> 16)) << 16) | (romOffset & 0x8000);
+        }
+
+        return -1;
+
+    case AddressMapMode::None:
+        break;
+    }
+
+    return -1;
+}
@@ -0,0 +1,107 @@
+#ifndef ADDRESSMAPPER_H
+#define ADDRESSMAPPER_H
+
+#include <QList>
+#include <QStringList>
+
+// Order matches the entries of the address map mode box.
+enum class AddressMapMode
+{
+    None,
+    LoRom,
+    HiRom,
+    ExLoRom,
+    ExHiRom,
+    Sa1Rom,
+    Sdd1Rom
+};
+
+// Translates between SNES bus addresses (BBAAAA) and file offsets.
+//
+// The bus is split into 512 slots of 32 KB. On construction every slot gets
+// the ROM offset it maps to, and every 32 KB slot of the ROM gets its
+// preferred bus address, so both directions are a table lookup plus a mask.
+// A 512 byte copier header is detected from the file size unless given
+// explicitly; file offsets always include it. In None mode addresses are
+// raw file offsets and pass through unchanged.
+class AddressMapper
+{
+public:
+    static const qsizetype autoDetectHeader = -1;
+
+    AddressMapper(AddressMapMode mode = AddressMapMode::None, qsizetype fileSize = 0, qsizetype headerSize = autoDetectHeader);
+
+    AddressMapMode mode() const;
+    quint32 headerSize() const;
+    quint32 romSize() const;
+
+    inline bool busToFile(quint32 busAddress, quint32 &fileOffset) const
+    {
+        if (mapMode == AddressMapMode::None)
+        {
+            fileOffset = busAddress;
+            return true;
+        }
+
+        qint32 slotBase = busSlotBase[(busAddress >> 15) & 0x1FF];
+
+        if (slotBase < 0)
+        {
+            return false;
+        }
+
+        quint32 romOffset = quint32(slotBase) + (busAddress & 0x7FFF);
+
+        if (romOffset >= romLength)
+        {
+            return false;
+        }
+
+        fileOffset = romOffset + header;
+        return true;
+    }
+
+    inline bool fileToBus(quint32 fileOffset, quint32 &busAddress) const
+    {
+        if (mapMode == AddressMapMode::None)
+        {
+            busAddress = fileOffset;
+            return true;
+        }
+
+        if (fileOffset < header || fileOffset - header >= romLength)
+        {
+            return false;
+        }
+
+        quint32 romOffset = fileOffset - header;
+        qint32 slotBus = fileSlotBus.at(romOffset >> 15);
+
+        if (slotBus < 0)
+        {
+            return false;
+        }
+
+        busAddress = quint32(slotBus) | (romOffset & 0x7FFF);
+        return true;
+    }
+
+    static QStringList modeNames();
+
+    // Address syntax shared by job and manifest files: "$C08000" and
+    // "C0:8000" are bus addresses, "0x1234" and bare hex are file offsets.
+    static bool parseAddress(QString string, quint32 &value, bool &busAddress);
+
+private:
+    AddressMapMode mapMode;
+    quint32 header;
+    quint32 romLength;
+
+    qint32 busSlotBase[512];
+    QList<qint32> fileSlotBus;
+
+    qint64 romOffsetForSlot(quint32 bank, bool upperHalf) const;
+    qint64 busAddressForRomSlot(quint32 romOffset) const;
+};
+
+#endif // ADDRESSMAPPER_H
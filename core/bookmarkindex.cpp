@@ -0,0 +1,455 @@
+#include "bookmarkindex.h"
+#include "romcache.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <cstring>
+
+static const quint32 indexMagic = 0x42495053; // "SPIB"
+static const quint16 indexVersion = 1;
+
+static const qsizetype headerSize = 16;
+static const qsizetype romRecordSize = 32;
+static const qsizetype entryRecordSize = 20;
+static const qsizetype sha1Size = 20;
+
+static const quint8 busAddressFlag = 0x01;
+
+static const int lockTimeout = 5000;
+
+
+
+template <typename T>
+static void appendLittleEndian(QByteArray &out, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, sizeof(T));
+}
+
+template <typename T>
+static T readLittleEndian(const uchar *data)
+{
+    return qFromLittleEndian<T>(data);
+}
+
+
+
+BookmarkIndex::BookmarkIndex()
+    : indexData(nullptr)
+    , indexSize(0)
+    , roms(0)
+    , entries(0)
+{
+}
+
+BookmarkIndex::~BookmarkIndex()
+{
+    close();
+}
+
+
+
+QString BookmarkIndex::defaultPath()
+{
+    return QFileInfo(RomCache::defaultDirectory()).path() + "/bookmarks.idx";
+}
+
+
+
+bool BookmarkIndex::open(const QString &path, QString &errorString)
+{
+    close();
+    indexPath = path;
+    openError.clear();
+
+    if (!QFileInfo::exists(indexPath))
+    {
+        return true;
+    }
+
+    file.setFileName(indexPath);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        errorString = "Failed to open bookmark index.";
+        openError = errorString;
+        return false;
+    }
+
+    indexSize = file.size();
+    indexData = indexSize > 0 ? file.map(0, indexSize) : nullptr;
+
+    if (indexData == nullptr)
+    {
+        buffer = file.readAll();
+        indexData = reinterpret_cast<const uchar *>(buffer.constData());
+        indexSize = buffer.size();
+    }
+
+    if (indexSize < headerSize
+        || readLittleEndian<quint32>(indexData) != indexMagic
+        || readLittleEndian<quint16>(indexData + 4) != indexVersion)
+    {
+        close();
+        errorString = "Bookmark index is damaged or from a newer version.";
+        openError = errorString;
+        return false;
+    }
+
+    roms = readLittleEndian<quint32>(indexData + 8);
+    entries = readLittleEndian<quint32>(indexData + 12);
+
+    if (headerSize + qint64(roms) * romRecordSize + qint64(entries) * entryRecordSize > indexSize)
+    {
+        close();
+        errorString = "Bookmark index is damaged.";
+        openError = errorString;
+        return false;
+    }
+
+    return true;
+}
+
+
+
+void BookmarkIndex::close()
+{
+    // Closing the file also removes its mapping.
+    file.close();
+    buffer.clear();
+    indexData = nullptr;
+    indexSize = 0;
+    roms = 0;
+    entries = 0;
+}
+
+
+
+int BookmarkIndex::romCount() const
+{
+    return int(roms);
+}
+
+int BookmarkIndex::bookmarkCount() const
+{
+    return int(entries);
+}
+
+
+
+const uchar *BookmarkIndex::romRecord(quint32 index) const
+{
+    return indexData + headerSize + qsizetype(index) * romRecordSize;
+}
+
+const uchar *BookmarkIndex::entryRecord(quint32 index) const
+{
+    return indexData + headerSize + qsizetype(roms) * romRecordSize + qsizetype(index) * entryRecordSize;
+}
+
+QByteArrayView BookmarkIndex::names() const
+{
+    const qsizetype poolOffset = headerSize + qsizetype(roms) * romRecordSize + qsizetype(entries) * entryRecordSize;
+    return QByteArrayView(indexData + poolOffset, indexSize - poolOffset);
+}
+
+
+
+// Index of the ROM's record, or of where it would be inserted.
+int BookmarkIndex::findRom(QByteArrayView sha1, bool &found) const
+{
+    quint32 low = 0;
+    quint32 high = roms;
+    found = false;
+
+    while (low < high)
+    {
+        const quint32 middle = low + (high - low) / 2;
+        const int order = memcmp(romRecord(middle), sha1.data(), sha1Size);
+
+        if (order == 0)
+        {
+            found = true;
+            return int(middle);
+        }
+
+        if (order < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return int(low);
+}
+
+
+
+QList<PaletteBookmark> BookmarkIndex::bookmarks(const RomFingerprint &fingerprint) const
+{
+    QList<PaletteBookmark> bookmarkList;
+    bool found;
+
+    if (!fingerprint.isValid() || fingerprint.headerlessSha1.size() != sha1Size)
+    {
+        return bookmarkList;
+    }
+
+    const int romIndex = findRom(fingerprint.headerlessSha1, found);
+
+    if (!found)
+    {
+        return bookmarkList;
+    }
+
+    const quint32 first = readLittleEndian<quint32>(romRecord(romIndex) + 20);
+    const quint32 count = readLittleEndian<quint32>(romRecord(romIndex) + 24);
+    const QByteArrayView pool = names();
+
+    if (first > entries || count > entries - first)
+    {
+        return bookmarkList;
+    }
+
+    bookmarkList.reserve(count);
+
+    for (quint32 i = first; i < first + count; i++)
+    {
+        const uchar *record = entryRecord(i);
+        const quint32 nameOffset = readLittleEndian<quint32>(record + 12);
+        const quint32 nameLength = readLittleEndian<quint32>(record + 16);
+        PaletteBookmark bookmark;
+
+        bookmark.settings.address = readLittleEndian<quint32>(record);
+        bookmark.settings.colorCount = readLittleEndian<quint16>(record + 4);
+        bookmark.settings.rowWidth = readLittleEndian<quint16>(record + 6);
+        bookmark.settings.busAddress = (record[9] & busAddressFlag) != 0;
+        bookmark.format = record[8] <= quint8(PaletteFileFormat::Bin) ? PaletteFileFormat(record[8]) : PaletteFileFormat::Image;
+
+        if (!bookmark.settings.busAddress)
+        {
+            bookmark.settings.address += fingerprint.copierHeader;
+        }
+
+        if (qsizetype(nameOffset) + nameLength <= pool.size())
+        {
+            bookmark.name = QString::fromUtf8(pool.sliced(nameOffset, nameLength));
+        }
+
+        bookmarkList.append(bookmark);
+    }
+
+    return bookmarkList;
+}
+
+
+
+static bool sameBookmark(const PaletteBookmark &a, const PaletteBookmark &b)
+{
+    return a.name == b.name && a.format == b.format
+        && a.settings.address == b.settings.address && a.settings.busAddress == b.settings.busAddress
+        && a.settings.colorCount == b.settings.colorCount && a.settings.rowWidth == b.settings.rowWidth;
+}
+
+
+
+bool BookmarkIndex::addBookmark(const RomFingerprint &fingerprint, const PaletteBookmark &bookmark, QString &errorString)
+{
+    return updateBookmarks(fingerprint, [&bookmark](QList<PaletteBookmark> &bookmarkList)
+    {
+        bookmarkList.append(bookmark);
+    }, errorString);
+}
+
+
+
+// Removing a bookmark another process already removed is not an error.
+bool BookmarkIndex::removeBookmark(const RomFingerprint &fingerprint, const PaletteBookmark &bookmark, QString &errorString)
+{
+    return updateBookmarks(fingerprint, [&bookmark](QList<PaletteBookmark> &bookmarkList)
+    {
+        for (int i = 0; i < bookmarkList.size(); i++)
+        {
+            if (sameBookmark(bookmarkList.at(i), bookmark))
+            {
+                bookmarkList.removeAt(i);
+                return;
+            }
+        }
+    }, errorString);
+}
+
+
+
+bool BookmarkIndex::updateBookmarks(const RomFingerprint &fingerprint, const std::function<void(QList<PaletteBookmark> &)> &change, QString &errorString)
+{
+    if (!openError.isEmpty())
+    {
+        errorString = openError + " It is left untouched; repair or delete it to keep bookmarks.";
+        return false;
+    }
+
+    if (!fingerprint.isValid() || fingerprint.headerlessSha1.size() != sha1Size)
+    {
+        errorString = "ROM has no fingerprint.";
+        return false;
+    }
+
+    const QString path = indexPath.isEmpty() ? defaultPath() : indexPath;
+
+    if (!QDir().mkpath(QFileInfo(path).path()))
+    {
+        errorString = "Failed to create bookmark folder.";
+        return false;
+    }
+
+    QLockFile lock(path + ".lock");
+
+    if (!lock.tryLock(lockTimeout))
+    {
+        errorString = "Bookmark index is in use by another program.";
+        return false;
+    }
+
+    // Pick up whatever was written since the index was opened.
+    if (!open(path, errorString))
+    {
+        return false;
+    }
+
+    QList<PaletteBookmark> bookmarkList = bookmarks(fingerprint);
+    change(bookmarkList);
+    return writeBookmarks(fingerprint, bookmarkList, errorString);
+}
+
+
+
+bool BookmarkIndex::writeBookmarks(const RomFingerprint &fingerprint, const QList<PaletteBookmark> &bookmarkList, QString &errorString)
+{
+    bool found;
+    const int romIndex = findRom(fingerprint.headerlessSha1, found);
+    const QByteArrayView pool = names();
+
+    QByteArray romTable;
+    QByteArray entryTable;
+    QByteArray namePool;
+    quint32 romTotal = 0;
+    quint32 entryTotal = 0;
+
+    auto appendRom = [&](QByteArrayView sha1, quint32 count)
+    {
+        romTable.append(sha1.data(), sha1Size);
+        appendLittleEndian<quint32>(romTable, entryTotal - count);
+        appendLittleEndian<quint32>(romTable, count);
+        appendLittleEndian<quint32>(romTable, 0);
+        romTotal++;
+    };
+
+    auto appendEntry = [&](quint32 address, quint16 colorCount, quint16 rowWidth, quint8 format, quint8 flags, QByteArrayView name)
+    {
+        appendLittleEndian<quint32>(entryTable, address);
+        appendLittleEndian<quint16>(entryTable, colorCount);
+        appendLittleEndian<quint16>(entryTable, rowWidth);
+        appendLittleEndian<quint8>(entryTable, format);
+        appendLittleEndian<quint8>(entryTable, flags);
+        appendLittleEndian<quint16>(entryTable, 0);
+        appendLittleEndian<quint32>(entryTable, quint32(namePool.size()));
+        appendLittleEndian<quint32>(entryTable, quint32(name.size()));
+        namePool.append(name);
+        entryTotal++;
+    };
+
+    auto appendNewRom = [&]()
+    {
+        for (const PaletteBookmark &bookmark : bookmarkList)
+        {
+            const PaletteSettings &settings = bookmark.settings;
+            const bool shifted = !settings.busAddress && settings.address >= fingerprint.copierHeader;
+            const quint32 address = shifted ? settings.address - fingerprint.copierHeader : settings.address;
+
+            appendEntry(address, quint16(settings.colorCount), quint16(settings.rowWidth), quint8(bookmark.format),
+                        settings.busAddress ? busAddressFlag : 0, bookmark.name.toUtf8());
+        }
+
+        if (!bookmarkList.isEmpty())
+        {
+            appendRom(fingerprint.headerlessSha1, quint32(bookmarkList.size()));
+        }
+    };
+
+    // Records are copied in hash order with the changed ROM dropped or
+    // put in its place; only the name offsets change.
+    for (quint32 rom = 0; rom < roms; rom++)
+    {
+        if (int(rom) == romIndex)
+        {
+            appendNewRom();
+
+            if (found)
+            {
+                continue;
+            }
+        }
+
+        const uchar *record = romRecord(rom);
+        const quint32 first = readLittleEndian<quint32>(record + 20);
+        const quint32 count = readLittleEndian<quint32>(record + 24);
+
+        if (first > entries || count > entries - first || count == 0)
+        {
+            continue;
+        }
+
+        for (quint32 i = first; i < first + count; i++)
+        {
+            const uchar *entry = entryRecord(i);
+            const quint32 nameOffset = readLittleEndian<quint32>(entry + 12);
+            const quint32 nameLength = readLittleEndian<quint32>(entry + 16);
+            const bool nameValid = qsizetype(nameOffset) + nameLength <= pool.size();
+
+            appendEntry(readLittleEndian<quint32>(entry), readLittleEndian<quint16>(entry + 4),
+                        readLittleEndian<quint16>(entry + 6), entry[8], entry[9],
+                        nameValid ? pool.sliced(nameOffset, nameLength) : QByteArrayView());
+        }
+
+        appendRom(QByteArrayView(record, sha1Size), count);
+    }
+
+    if (romIndex == int(roms))
+    {
+        appendNewRom();
+    }
+
+    QByteArray contents;
+    appendLittleEndian<quint32>(contents, indexMagic);
+    appendLittleEndian<quint16>(contents, indexVersion);
+    appendLittleEndian<quint16>(contents, 0);
+    appendLittleEndian<quint32>(contents, romTotal);
+    appendLittleEndian<quint32>(contents, entryTotal);
+    contents += romTable + entryTable + namePool;
+
+    const QString path = indexPath;
+
+    // The old file is unmapped first so it can be replaced on every OS.
+    close();
+
+    QSaveFile saveFile(path);
+
+    if (!saveFile.open(QIODevice::WriteOnly) || saveFile.write(contents) != contents.size() || !saveFile.commit())
+    {
+        QString reopenError;
+        open(path, reopenError);
+        errorString = "Failed to write bookmark index.";
+        return false;
+    }
+
+    return open(path, errorString);
+}
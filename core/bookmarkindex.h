@@ -0,0 +1,78 @@
+#ifndef BOOKMARKINDEX_H
+#define BOOKMARKINDEX_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+#include <functional>
+
+#include "importmanifest.h"
+#include "paletteengine.h"
+
+struct PaletteBookmark
+{
+    QString name;
+    PaletteSettings settings;
+    PaletteFileFormat format = PaletteFileFormat::Image;
+};
+
+// Named palette addresses for every ROM, kept in one binary file that is
+// memory-mapped on open, so opening it does not depend on its size.
+//
+// Layout (little endian): a 16 byte header (magic, version, ROM count,
+// bookmark count), one 32 byte record per ROM sorted by headerless SHA-1
+// (hash, first bookmark, bookmark count), one 20 byte record per bookmark
+// (address, color count, row width, format, flags, name offset and
+// length) and a UTF-8 pool of names. Looking up a ROM is a binary search
+// and only its own records are decoded. File offsets are stored without
+// the copier header, as in RomCache.
+//
+// Changing a ROM's bookmarks rewrites the file, copying the other ROMs'
+// records as they are; that is a few hundred KB for tens of thousands of
+// bookmarks. The window and spi may share the file, so every change locks
+// it, reads it again and applies only its own addition or removal. An
+// index that failed to open is never written, so a damaged file is not
+// replaced with the current ROM's bookmarks alone.
+class BookmarkIndex
+{
+public:
+    BookmarkIndex();
+    ~BookmarkIndex();
+
+    // Next to the ROM cache folder (see RomCache::defaultDirectory()).
+    static QString defaultPath();
+
+    // A missing file opens as an empty index.
+    bool open(const QString &indexPath, QString &errorString);
+    void close();
+
+    int romCount() const;
+    int bookmarkCount() const;
+
+    QList<PaletteBookmark> bookmarks(const RomFingerprint &fingerprint) const;
+    bool addBookmark(const RomFingerprint &fingerprint, const PaletteBookmark &bookmark, QString &errorString);
+    bool removeBookmark(const RomFingerprint &fingerprint, const PaletteBookmark &bookmark, QString &errorString);
+
+private:
+    Q_DISABLE_COPY(BookmarkIndex)
+
+    QString indexPath;
+    QString openError;
+    QFile file;
+    QByteArray buffer;
+    const uchar *indexData;
+    qsizetype indexSize;
+    quint32 roms;
+    quint32 entries;
+
+    const uchar *romRecord(quint32 index) const;
+    const uchar *entryRecord(quint32 index) const;
+    QByteArrayView names() const;
+    int findRom(QByteArrayView sha1, bool &found) const;
+    bool updateBookmarks(const RomFingerprint &fingerprint, const std::function<void(QList<PaletteBookmark> &)> &change, QString &errorString);
+    bool writeBookmarks(const RomFingerprint &fingerprint, const QList<PaletteBookmark> &bookmarks, QString &errorString);
+};
+
+#endif // BOOKMARKINDEX_H
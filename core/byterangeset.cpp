@@ -0,0 +1,102 @@
+#include "byterangeset.h"
+
+void ByteRangeSet::add(qsizetype offset, qsizetype length)
+{
+    if (length <= 0)
+    {
+        return;
+    }
+
+    qsizetype start = offset;
+    qsizetype end = offset + length;
+
+    auto it = spans.upperBound(start);
+
+    if (it != spans.begin())
+    {
+        auto previous = std::prev(it);
+
+        if (previous.value() >= start)
+        {
+            start = previous.key();
+            end = qMax(end, previous.value());
+            it = spans.erase(previous);
+        }
+    }
+
+    while (it != spans.end() && it.key() <= end)
+    {
+        end = qMax(end, it.value());
+        it = spans.erase(it);
+    }
+
+    spans.insert(start, end);
+}
+
+
+
+void ByteRangeSet::clear()
+{
+    spans.clear();
+}
+
+bool ByteRangeSet::isEmpty() const
+{
+    return spans.isEmpty();
+}
+
+int ByteRangeSet::count() const
+{
+    return spans.size();
+}
+
+
+
+qsizetype ByteRangeSet::totalBytes() const
+{
+    qsizetype total = 0;
+
+    for (auto it = spans.cbegin(); it != spans.cend(); ++it)
+    {
+        total += it.value() - it.key();
+    }
+
+    return total;
+}
+
+
+
+bool ByteRangeSet::intersects(qsizetype offset, qsizetype length) const
+{
+    if (length <= 0)
+    {
+        return false;
+    }
+
+    auto it = spans.upperBound(offset);
+
+    if (it != spans.cbegin() && std::prev(it).value() > offset)
+    {
+        return true;
+    }
+
+    return it != spans.cend() && it.key() < offset + length;
+}
+
+
+
+QList<ByteRange> ByteRangeSet::ranges() const
+{
+    QList<ByteRange> result;
+    result.reserve(spans.size());
+
+    for (auto it = spans.cbegin(); it != spans.cend(); ++it)
+    {
+        ByteRange range;
+        range.offset = it.key();
+        range.length = it.value() - it.key();
+        result.append(range);
+    }
+
+    return result;
+}
@@ -0,0 +1,37 @@
+#ifndef BYTERANGESET_H
+#define BYTERANGESET_H
+
+#include <QList>
+#include <QMap>
+
+#include <iterator>
+
+struct ByteRange
+{
+    qsizetype offset = 0;
+    qsizetype length = 0;
+
+    qsizetype end() const { return offset + length; }
+};
+
+// Sorted set of byte ranges. Overlapping and touching ranges are merged on
+// insertion, so the set always holds the minimal list of disjoint spans.
+class ByteRangeSet
+{
+public:
+    void add(qsizetype offset, qsizetype length);
+    void clear();
+
+    bool isEmpty() const;
+    int count() const;
+    qsizetype totalBytes() const;
+    bool intersects(qsizetype offset, qsizetype length) const;
+
+    QList<ByteRange> ranges() const;
+
+private:
+    // Range start -> range end (exclusive).
+    QMap<qsizetype, qsizetype> spans;
+};
+
+#endif // BYTERANGESET_H
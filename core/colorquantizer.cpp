@@ -0,0 +1,285 @@
+#include "colorquantizer.h"
+#include "snescolor.h"
+
+#include <QAtomicPointer>
+
+#include <cmath>
+
+namespace
+{
+
+struct OkLabColor
+{
+    float L;
+    float a;
+    float b;
+};
+
+
+
+// Per channel 8 bit -> 5 bit tables for Round and OrderedDither. The dither
+// table is indexed by the 4x4 Bayer cell, (y & 3) * 4 + (x & 3).
+struct ChannelTables
+{
+    quint8 round[256];
+    quint8 dither[16][256];
+
+    ChannelTables()
+    {
+        static const quint8 bayer[16] = { 0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5 };
+
+        for (int value = 0; value < 256; value++)
+        {
+            round[value] = quint8((value * 31 + 127) / 255);
+
+            for (int cell = 0; cell < 16; cell++)
+            {
+                dither[cell][value] = quint8(qMin(31, int(value * 31 / 255.0 + (bayer[cell] + 0.5) / 16.0)));
+            }
+        }
+    }
+};
+
+}
+
+
+
+static const ChannelTables &channelTables()
+{
+    static const ChannelTables tables;
+    return tables;
+}
+
+
+
+static const float *srgbToLinearTable()
+{
+    static const QList<float> table = []
+    {
+        QList<float> linear(256);
+
+        for (int value = 0; value < 256; value++)
+        {
+            float c = value / 255.0f;
+            linear[value] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        return linear;
+    }();
+
+    return table.constData();
+}
+
+
+
+static OkLabColor toOkLab(quint8 red, quint8 green, quint8 blue)
+{
+    const float *linear = srgbToLinearTable();
+    const float r = linear[red];
+    const float g = linear[green];
+    const float b = linear[blue];
+
+    const float l = std::cbrt(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+    const float m = std::cbrt(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+    const float s = std::cbrt(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
+
+    return { 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s,
+             1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s,
+             0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s };
+}
+
+
+
+// OKLab of every BGR555 color as the SNES displays it (see snesToRGB()).
+static const OkLabColor *snesOkLabTable()
+{
+    static const QList<OkLabColor> table = []
+    {
+        QList<OkLabColor> colors(32768);
+
+        for (int snesColor = 0; snesColor < 32768; snesColor++)
+        {
+            QRgb rgb = snesToRGB(snesColor);
+            colors[snesColor] = toOkLab(qRed(rgb), qGreen(rgb), qBlue(rgb));
+        }
+
+        return colors;
+    }();
+
+    return table.constData();
+}
+
+
+
+// 24 bit -> BGR555 for one red value, indexed by (green << 8) | blue. Only
+// the 3x3x3 levels around the rounded color are searched, which is where
+// the perceptually nearest one lies in practice.
+static quint16 *buildOkLabSlab(quint8 red)
+{
+    const ChannelTables &tables = channelTables();
+    const OkLabColor *snesColors = snesOkLabTable();
+    quint16 *slab = new quint16[65536];
+
+    const int redLevel = tables.round[red];
+    const int redFirst = qMax(0, redLevel - 1);
+    const int redLast = qMin(31, redLevel + 1);
+
+    for (int green = 0; green < 256; green++)
+    {
+        const int greenLevel = tables.round[green];
+        const int greenFirst = qMax(0, greenLevel - 1);
+        const int greenLast = qMin(31, greenLevel + 1);
+
+        for (int blue = 0; blue < 256; blue++)
+        {
+            const int blueLevel = tables.round[blue];
+            const OkLabColor target = toOkLab(red, green, blue);
+            float bestDistance = INFINITY;
+            quint16 best = 0;
+
+            for (int b = qMax(0, blueLevel - 1); b <= qMin(31, blueLevel + 1); b++)
+            {
+                for (int g = greenFirst; g <= greenLast; g++)
+                {
+                    for (int r = redFirst; r <= redLast; r++)
+                    {
+                        const quint16 candidate = quint16(r | (g << 5) | (b << 10));
+                        const OkLabColor &color = snesColors[candidate];
+                        const float dL = color.L - target.L;
+                        const float da = color.a - target.a;
+                        const float db = color.b - target.b;
+                        const float distance = dL * dL + da * da + db * db;
+
+                        if (distance < bestDistance)
+                        {
+                            bestDistance = distance;
+                            best = candidate;
+                        }
+                    }
+                }
+            }
+
+            slab[(green << 8) | blue] = best;
+        }
+    }
+
+    return slab;
+}
+
+
+
+// Slabs live for the rest of the process (32 MB once every red value was
+// seen). Two threads may race to build the same slab; the loser's copy is
+// dropped.
+static const quint16 *okLabSlab(quint8 red)
+{
+    static QAtomicPointer<quint16> slabs[256];
+
+    quint16 *slab = slabs[red].loadAcquire();
+
+    if (slab == nullptr)
+    {
+        quint16 *built = buildOkLabSlab(red);
+
+        if (slabs[red].testAndSetOrdered(nullptr, built))
+        {
+            slab = built;
+        }
+        else
+        {
+            delete[] built;
+            slab = slabs[red].loadAcquire();
+        }
+    }
+
+    return slab;
+}
+
+
+
+template <typename PixelAt>
+static void quantizeRun(PixelAt pixelAt, uchar *snesData, qsizetype count, ColorQuantization mode, quint32 x, quint32 y)
+{
+    const ChannelTables &tables = channelTables();
+
+    for (qsizetype i = 0; i < count; i++)
+    {
+        quint8 red;
+        quint8 green;
+        quint8 blue;
+        pixelAt(i, red, green, blue);
+
+        quint16 snesColor;
+
+        switch (mode)
+        {
+        case ColorQuantization::Round:
+            snesColor = tables.round[red] | (tables.round[green] << 5) | (tables.round[blue] << 10);
+            break;
+
+        case ColorQuantization::OrderedDither:
+        {
+            const quint8 *dither = tables.dither[((y & 3) << 2) | ((x + i) & 3)];
+            snesColor = dither[red] | (dither[green] << 5) | (dither[blue] << 10);
+            break;
+        }
+
+        case ColorQuantization::OkLab:
+            snesColor = okLabSlab(red)[(green << 8) | blue];
+            break;
+
+        case ColorQuantization::Truncate:
+        default:
+            snesColor = (red >> 3) | ((green >> 3) << 5) | ((blue >> 3) << 10);
+            break;
+        }
+
+        snesData[i * 2] = snesColor & 0xFF;
+        snesData[i * 2 + 1] = snesColor >> 8;
+    }
+}
+
+
+
+QStringList colorQuantizationNames()
+{
+    return QStringList() << "Truncate" << "Round" << "Ordered Dither" << "OKLab Nearest";
+}
+
+
+
+void quantizeToSNES(const QRgb *rgbData, uchar *snesData, qsizetype count, ColorQuantization mode, quint32 x, quint32 y)
+{
+    if (mode == ColorQuantization::Truncate)
+    {
+        rgbToSNESBulk(rgbData, snesData, count);
+        return;
+    }
+
+    quantizeRun([rgbData](qsizetype i, quint8 &red, quint8 &green, quint8 &blue)
+                {
+                    red = qRed(rgbData[i]);
+                    green = qGreen(rgbData[i]);
+                    blue = qBlue(rgbData[i]);
+                },
+                snesData, count, mode, x, y);
+}
+
+
+
+void quantizeRGB888ToSNES(const uchar *rgbData, uchar *snesData, qsizetype count, ColorQuantization mode, quint32 x, quint32 y)
+{
+    if (mode == ColorQuantization::Truncate)
+    {
+        rgb888ToSNESBulk(rgbData, snesData, count);
+        return;
+    }
+
+    quantizeRun([rgbData](qsizetype i, quint8 &red, quint8 &green, quint8 &blue)
+                {
+                    red = rgbData[i * 3];
+                    green = rgbData[i * 3 + 1];
+                    blue = rgbData[i * 3 + 2];
+                },
+                snesData, count, mode, x, y);
+}
@@ -0,0 +1,30 @@
+#ifndef COLORQUANTIZER_H
+#define COLORQUANTIZER_H
+
+#include <QRgb>
+#include <QStringList>
+
+// How 24 bit RGB is reduced to BGR555 when importing. Order matches the
+// entries of the color quantization box.
+enum class ColorQuantization
+{
+    Truncate,
+    Round,
+    OrderedDither,
+    OkLab
+};
+
+QStringList colorQuantizationNames();
+
+// Quantize a run of pixels that starts at image position (x, y) and runs
+// along one row; the position only matters for OrderedDither. Output is
+// little endian words like rgbToSNESBulk(), which Truncate forwards to.
+// OkLab picks the SNES color nearest in OKLab space through a lookup table
+// built lazily one red slab (64K entries) at a time, so after warm-up every
+// mode is a table lookup per pixel.
+void quantizeToSNES(const QRgb *rgbData, uchar *snesData, qsizetype count,
+                    ColorQuantization mode, quint32 x = 0, quint32 y = 0);
+void quantizeRGB888ToSNES(const uchar *rgbData, uchar *snesData, qsizetype count,
+                          ColorQuantization mode, quint32 x = 0, quint32 y = 0);
+
+#endif // COLORQUANTIZER_H
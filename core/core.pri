@@ -0,0 +1,56 @@
+# Palette engine sources, compiled once into the spicore library by
+# core.pro. Programs link it through spicore.pri instead.
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/addressmapper.cpp \
+    $$PWD/bookmarkindex.cpp \
+    $$PWD/byterangeset.cpp \
+    $$PWD/colorquantizer.cpp \
+    $$PWD/cpufeatures.cpp \
+    $$PWD/crc32.cpp \
+    $$PWD/editjournal.cpp \
+    $$PWD/importmanifest.cpp \
+    $$PWD/paletteengine.cpp \
+    $$PWD/paletteindex.cpp \
+    $$PWD/palettescanner.cpp \
+    $$PWD/romcache.cpp \
+    $$PWD/romdiff.cpp \
+    $$PWD/rompatch.cpp \
+    $$PWD/romstorage.cpp \
+    $$PWD/sneschecksum.cpp \
+    $$PWD/snescolor.cpp \
+    $$PWD/tilequantizer.cpp
+
+HEADERS += \
+    $$PWD/addressmapper.h \
+    $$PWD/bookmarkindex.h \
+    $$PWD/byterangeset.h \
+    $$PWD/colorquantizer.h \
+    $$PWD/cpufeatures.h \
+    $$PWD/crc32.h \
+    $$PWD/editjournal.h \
+    $$PWD/importmanifest.h \
+    $$PWD/paletteengine.h \
+    $$PWD/paletteindex.h \
+    $$PWD/palettescanner.h \
+    $$PWD/romcache.h \
+    $$PWD/romdiff.h \
+    $$PWD/romdiff_p.h \
+    $$PWD/rompatch.h \
+    $$PWD/romstorage.h \
+    $$PWD/sneschecksum.h \
+    $$PWD/snescolor.h \
+    $$PWD/snescolor_p.h \
+    $$PWD/tilequantizer.h
+
+# Bulk color conversion and ROM compare kernels, compiled with their own
+# instruction set flags and picked at runtime.
+contains(QT_ARCH, x86_64)|contains(QT_ARCH, i386) {
+    CONFIG += simd
+    DEFINES += SPI_X86_SIMD
+    SSE2_SOURCES += $$PWD/romdiff_sse2.cpp $$PWD/snescolor_sse2.cpp
+    AVX2_SOURCES += $$PWD/romdiff_avx2.cpp $$PWD/snescolor_avx2.cpp
+}
@@ -0,0 +1,11 @@
+# GUI-free palette engine built as a static library, linked by the GUI,
+# spi and the tests through spicore.pri.
+
+QT       = core gui concurrent
+
+TEMPLATE = lib
+CONFIG += staticlib c++17
+
+TARGET = spicore
+
+include(core.pri)
@@ -0,0 +1,64 @@
+#include "cpufeatures.h"
+
+#include <QtGlobal>
+
+#if defined(SPI_X86_SIMD) && defined(Q_CC_MSVC)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#if defined(SPI_X86_SIMD)
+
+static bool detectAVX2()
+{
+#if defined(Q_CC_MSVC)
+    int info[4];
+    __cpuid(info, 0);
+
+    if (info[0] < 7)
+    {
+        return false;
+    }
+
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+
+
+bool cpuHasSSE2()
+{
+#if defined(SPI_X86_SIMD)
+    // SSE2 is part of the x86-64 baseline and of every x86 CPU Qt 6 supports.
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+
+bool cpuHasAVX2()
+{
+#if defined(SPI_X86_SIMD)
+    static const bool hasAVX2 = detectAVX2();
+    return hasAVX2;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,9 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+// Runtime CPU feature checks used to pick SIMD kernels. All of them return
+// false on targets where the corresponding kernels are not built.
+bool cpuHasSSE2();
+bool cpuHasAVX2();
+
+#endif // CPUFEATURES_H
@@ -0,0 +1,72 @@
+#include "crc32.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+namespace
+{
+
+struct Crc32Tables
+{
+    quint32 table[8][256];
+
+    Crc32Tables()
+    {
+        for (quint32 i = 0; i < 256; i++)
+        {
+            quint32 crc = i;
+
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+            }
+
+            table[0][i] = crc;
+        }
+
+        for (quint32 i = 0; i < 256; i++)
+        {
+            for (int slice = 1; slice < 8; slice++)
+            {
+                table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+}
+
+
+
+quint32 crc32(const void *data, qsizetype length, quint32 crc)
+{
+    static const Crc32Tables tables;
+    const quint32 (*t)[256] = tables.table;
+    const uchar *bytes = static_cast<const uchar *>(data);
+
+    crc = ~crc;
+
+    while (length >= 8)
+    {
+        quint32 low;
+        quint32 high;
+        memcpy(&low, bytes, 4);
+        memcpy(&high, bytes + 4, 4);
+        low = qFromLittleEndian(low) ^ crc;
+        high = qFromLittleEndian(high);
+
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+            ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+
+        bytes += 8;
+        length -= 8;
+    }
+
+    while (length-- > 0)
+    {
+        crc = (crc >> 8) ^ t[0][(crc ^ *bytes++) & 0xFF];
+    }
+
+    return ~crc;
+}
@@ -0,0 +1,16 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <QByteArrayView>
+
+// CRC-32 (IEEE 802.3, as used by zip, IPS/BPS tools and ROM databases),
+// computed eight bytes at a time with slicing tables. Pass the previous
+// result as crc to continue over several buffers.
+quint32 crc32(const void *data, qsizetype length, quint32 crc = 0);
+
+inline quint32 crc32(QByteArrayView data, quint32 crc = 0)
+{
+    return crc32(data.data(), data.size(), crc);
+}
+
+#endif // CRC32_H
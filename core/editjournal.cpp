@@ -0,0 +1,145 @@
+#include "editjournal.h"
+
+static const qsizetype defaultMemoryLimit = 64 * 1024 * 1024;
+
+
+
+EditJournal::EditJournal()
+    : position(0)
+    , bytesUsed(0)
+    , byteLimit(defaultMemoryLimit)
+{
+}
+
+
+
+ByteRange EditJournal::record(quint32 offset, QByteArrayView before, QByteArrayView after, bool joinPrevious)
+{
+    qsizetype length = qMin(before.size(), after.size());
+    qsizetype first = 0;
+
+    while (first < length && before.at(first) == after.at(first))
+    {
+        first++;
+    }
+
+    if (first == length)
+    {
+        return ByteRange();
+    }
+
+    while (length > first && before.at(length - 1) == after.at(length - 1))
+    {
+        length--;
+    }
+
+    while (deltas.size() > position)
+    {
+        bytesUsed -= deltas.last().before.size() * 2;
+        deltas.removeLast();
+    }
+
+    EditDelta delta;
+    delta.offset = offset + quint32(first);
+    delta.before = before.sliced(first, length - first).toByteArray();
+    delta.after = after.sliced(first, length - first).toByteArray();
+    delta.joined = joinPrevious && !deltas.isEmpty();
+
+    bytesUsed += delta.before.size() * 2;
+    deltas.append(delta);
+    position = deltas.size();
+
+    while (bytesUsed > byteLimit && deltas.size() > 1)
+    {
+        dropOldest();
+    }
+
+    return { delta.offset, length - first };
+}
+
+
+
+void EditJournal::clear()
+{
+    deltas.clear();
+    position = 0;
+    bytesUsed = 0;
+}
+
+
+
+void EditJournal::dropOldest()
+{
+    bytesUsed -= deltas.first().before.size() * 2;
+    deltas.removeFirst();
+    position--;
+
+    // The rest of a partly dropped step becomes a step of its own.
+    if (!deltas.isEmpty())
+    {
+        deltas.first().joined = false;
+    }
+}
+
+
+
+bool EditJournal::canUndo() const
+{
+    return position > 0;
+}
+
+bool EditJournal::canRedo() const
+{
+    return position < deltas.size();
+}
+
+int EditJournal::undoCount() const
+{
+    return int(position);
+}
+
+int EditJournal::redoCount() const
+{
+    return int(deltas.size() - position);
+}
+
+
+
+const EditDelta &EditJournal::undo()
+{
+    return deltas.at(--position);
+}
+
+const EditDelta &EditJournal::redo()
+{
+    return deltas.at(position++);
+}
+
+bool EditJournal::nextRedoJoined() const
+{
+    return position < deltas.size() && deltas.at(position).joined;
+}
+
+
+
+qsizetype EditJournal::memoryUsage() const
+{
+    return bytesUsed;
+}
+
+qsizetype EditJournal::memoryLimit() const
+{
+    return byteLimit;
+}
+
+void EditJournal::setMemoryLimit(qsizetype bytes)
+{
+    byteLimit = bytes;
+
+    // Only edits that can still be undone are dropped; the redo side would
+    // not apply cleanly without them.
+    while (bytesUsed > byteLimit && position > 0)
+    {
+        dropOldest();
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+
+#include "byterangeset.h"
+
+struct EditDelta
+{
+    quint32 offset = 0;
+    QByteArray before;
+    QByteArray after;
+
+    // Undone and redone together with the delta recorded before it.
+    bool joined = false;
+};
+
+// Undo/redo history of ROM edits.
+//
+// Each edit is stored as the span that actually changed, with its bytes
+// before and after, so memory grows with the bytes edited rather than with
+// the ROM size. Undo and redo only hand back the delta to apply; writing it
+// is up to the owner of the data. Once the history exceeds memoryLimit()
+// the oldest edits are dropped.
+class EditJournal
+{
+public:
+    EditJournal();
+
+    // Trims the unchanged head and tail of an edit, records the rest and
+    // drops the redo history. Returns the recorded range, which is empty
+    // when no byte changed. With joinPrevious the edit forms one undo step
+    // with the one recorded before it.
+    ByteRange record(quint32 offset, QByteArrayView before, QByteArrayView after, bool joinPrevious = false);
+    void clear();
+
+    bool canUndo() const;
+    bool canRedo() const;
+    int undoCount() const;
+    int redoCount() const;
+
+    // Step back or forward. The returned delta's before (undo) or after
+    // (redo) bytes must be written at its offset. Only valid when
+    // canUndo()/canRedo(). A joined delta needs the next undo too, and
+    // nextRedoJoined() tells whether the next redo belongs to the same step.
+    const EditDelta &undo();
+    const EditDelta &redo();
+    bool nextRedoJoined() const;
+
+    qsizetype memoryUsage() const;
+    qsizetype memoryLimit() const;
+    void setMemoryLimit(qsizetype bytes);
+
+private:
+    QList<EditDelta> deltas;
+    qsizetype position;
+    qsizetype bytesUsed;
+    qsizetype byteLimit;
+
+    void dropOldest();
+};
+
+#endif // EDITJOURNAL_H
@@ -0,0 +1,144 @@
+#include "importmanifest.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTextStream>
+
+static bool parseFormat(const QString &name, const QString &filePath, PaletteFileFormat &format)
+{
+    static const QStringList names = { "image", "pal", "bin" };
+    const QString lowerName = name.toLower();
+
+    if (lowerName == "auto")
+    {
+        format = ImportManifest::formatForPath(filePath);
+        return true;
+    }
+
+    if (lowerName == "png")
+    {
+        format = PaletteFileFormat::Image;
+        return true;
+    }
+
+    int index = names.indexOf(lowerName);
+
+    if (index < 0)
+    {
+        return false;
+    }
+
+    format = PaletteFileFormat(index);
+    return true;
+}
+
+
+
+static bool parseCount(const QString &string, quint32 &value)
+{
+    if (string.compare("auto", Qt::CaseInsensitive) == 0)
+    {
+        value = 0;
+        return true;
+    }
+
+    bool convertOK;
+    value = string.toUInt(&convertOK);
+    return convertOK && value > 0;
+}
+
+
+
+PaletteFileFormat ImportManifest::formatForPath(const QString &filePath)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+
+    if (suffix == "pal")
+    {
+        return PaletteFileFormat::Pal;
+    }
+
+    if (suffix == "bin" || suffix == "cgr" || suffix == "cgram")
+    {
+        return PaletteFileFormat::Bin;
+    }
+
+    return PaletteFileFormat::Image;
+}
+
+
+
+bool ImportManifest::load(const QString &manifestPath, QList<ManifestEntry> &entries, QString &errorString)
+{
+    QFile manifestFile(manifestPath);
+
+    if (!manifestFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        errorString = "Failed to open manifest file.";
+        return false;
+    }
+
+    return parse(&manifestFile, QFileInfo(manifestPath).absoluteDir(), entries, errorString);
+}
+
+
+
+bool ImportManifest::parse(QIODevice *device, const QDir &baseDir, QList<ManifestEntry> &entries, QString &errorString)
+{
+    QTextStream manifestStream(device);
+    int lineNumber = 0;
+
+    entries.clear();
+
+    while (!manifestStream.atEnd())
+    {
+        QString line = manifestStream.readLine().trimmed();
+        lineNumber++;
+
+        if (line.isEmpty() || line.startsWith("#"))
+        {
+            continue;
+        }
+
+        const QStringList fields = QProcess::splitCommand(line);
+        ManifestEntry entry;
+        entry.line = lineNumber;
+
+        if (fields.size() != 5)
+        {
+            errorString = QString("line %1: expected <address> <format> <colorCount> <rowWidth> <file>.").arg(lineNumber);
+            return false;
+        }
+
+        if (!AddressMapper::parseAddress(fields.at(0), entry.settings.address, entry.settings.busAddress))
+        {
+            errorString = QString("line %1: invalid address \"%2\".").arg(lineNumber).arg(fields.at(0));
+            return false;
+        }
+
+        entry.filePath = baseDir.absoluteFilePath(fields.at(4));
+
+        if (!parseFormat(fields.at(1), entry.filePath, entry.format))
+        {
+            errorString = QString("line %1: unknown format \"%2\".").arg(lineNumber).arg(fields.at(1));
+            return false;
+        }
+
+        if (!parseCount(fields.at(2), entry.settings.colorCount) || !parseCount(fields.at(3), entry.settings.rowWidth))
+        {
+            errorString = QString("line %1: invalid color count or row width.").arg(lineNumber);
+            return false;
+        }
+
+        entries.append(entry);
+    }
+
+    if (entries.isEmpty())
+    {
+        errorString = "Manifest lists no palettes.";
+        return false;
+    }
+
+    return true;
+}
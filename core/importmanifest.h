@@ -0,0 +1,46 @@
+#ifndef IMPORTMANIFEST_H
+#define IMPORTMANIFEST_H
+
+#include <QDir>
+#include <QIODevice>
+#include <QList>
+#include <QString>
+
+#include "paletteengine.h"
+
+enum class PaletteFileFormat
+{
+    Image,
+    Pal,
+    Bin
+};
+
+struct ManifestEntry
+{
+    int line = 0;
+    QString filePath;
+    PaletteFileFormat format = PaletteFileFormat::Image;
+
+    // A colorCount of 0 takes every color the file holds, a rowWidth of 0
+    // the default of 16. Images always use their own width.
+    PaletteSettings settings;
+};
+
+// Batch import list for PaletteEngine::importManifest().
+//
+// One entry per line, '#' starts a comment:
+//   <address> <format> <colorCount> <rowWidth> <file>
+// The address uses the job file syntax (AddressMapper::parseAddress()),
+// format is image, pal, bin or auto (picked from the file suffix),
+// colorCount and rowWidth may be "auto", and relative file paths are
+// resolved against the manifest's folder. Quote fields containing spaces.
+class ImportManifest
+{
+public:
+    static bool load(const QString &manifestPath, QList<ManifestEntry> &entries, QString &errorString);
+    static bool parse(QIODevice *device, const QDir &baseDir, QList<ManifestEntry> &entries, QString &errorString);
+
+    static PaletteFileFormat formatForPath(const QString &filePath);
+};
+
+#endif // IMPORTMANIFEST_H
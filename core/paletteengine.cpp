@@ -0,0 +1,1810 @@
+#include "paletteengine.h"
+#include "crc32.h"
+#include "importmanifest.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+
+// Bytes read per loadRomChunk() call and written per save progress step.
+static const qsizetype romIoChunkSize = 256 * 1024;
+
+// Palettes encoded per bulk extract batch; one batch is written while the
+// next one is being encoded.
+static const qsizetype extractBatchSize = 256;
+
+PaletteEngine::PaletteEngine()
+    : appliedPatchCount(0)
+    , sourceSize(0)
+    , sourceHeaderSize(0)
+    , sourceCrc(0)
+    , headerlessCrc(0)
+    , sourceSha1(QCryptographicHash::Sha1)
+    , headerlessSha1(QCryptographicHash::Sha1)
+    , hashedSize(0)
+    , sourceHashed(false)
+    , quantization(ColorQuantization::Truncate)
+    , updateChecksumOnSave(true)
+    , editGroupOpen(false)
+    , editGroupRecorded(false)
+{
+}
+
+
+
+bool PaletteEngine::openRom(const QString &filePath, const QStringList &patchPaths)
+{
+    if (!beginOpenRom(filePath, patchPaths))
+    {
+        return false;
+    }
+
+    // Unlike loadRomChunk() this leaves a mapped file to be paged in as it
+    // is used.
+    rom.loadRemaining();
+    return finishOpenRom();
+}
+
+
+
+bool PaletteEngine::beginOpenRom(const QString &filePath, const QStringList &patchPaths)
+{
+    if (filePath.isEmpty())
+    {
+        setError("No ROM path provided.");
+        return false;
+    }
+
+    if (!rom.openDeferred(filePath))
+    {
+        setError(rom.errorString());
+
+        // The previous ROM may already be gone; drop its edit state too.
+        if (!rom.isOpen())
+        {
+            closeRom();
+        }
+
+        return false;
+    }
+
+    dirtyRanges.clear();
+    journal.clear();
+    patchRanges.clear();
+    searchIndex.clear();
+    pendingPatchPaths = patchPaths;
+    appliedPatchCount = 0;
+    sourceSize = rom.size();
+    sourceFingerprint = RomFingerprint();
+    sourceHashed = false;
+    resetSourceHash();
+    romChecksum = SnesChecksum();
+
+    // The mapper may be replaced while loading, so the loading thread only
+    // uses this copy of the header size.
+    mapper = AddressMapper(mapper.mode(), rom.size());
+    sourceHeaderSize = mapper.headerSize();
+    return true;
+}
+
+
+
+// Runs on the loading thread; only the ROM bytes past loadedSize() and the
+// running source hashes are touched, none of which the owner reads before
+// finishOpenRom(). Hashing the chunks as they arrive spares the window a
+// second pass over the file for the fingerprint.
+qsizetype PaletteEngine::loadRomChunk()
+{
+    const qsizetype first = rom.loadedSize();
+    const qsizetype count = rom.loadChunk(romIoChunkSize);
+
+    if (count > 0)
+    {
+        hashSourceChunk(rom.view(first, count));
+    }
+
+    return count;
+}
+
+
+
+// Unlike finishOpenRom() this may run on the loading thread, so the mapper
+// is not used. Patches are applied after this, so a patched ROM is still
+// summed on first use.
+void PaletteEngine::prepareRomSums()
+{
+    if (rom.isComplete() && pendingPatchPaths.isEmpty() && romChecksum.isEmpty())
+    {
+        romChecksum.reset(rom.size(), sourceHeaderSize);
+        romChecksum.add(0, rom.view(0, rom.size()));
+    }
+}
+
+
+
+// Runs on the owner's thread once loading is done: it replaces the mapper,
+// which the owner reads at any time.
+bool PaletteEngine::finishOpenRom()
+{
+    const QStringList patchPaths = pendingPatchPaths;
+    pendingPatchPaths.clear();
+
+    if (!rom.isComplete())
+    {
+        setError(rom.errorString().isEmpty() ? "ROM file was not read completely." : rom.errorString());
+        rom.close();
+        return false;
+    }
+
+    if (hashedSize == sourceSize)
+    {
+        finishSourceHash();
+    }
+
+    for (const QString &patchPath : patchPaths)
+    {
+        QFile patchFile(patchPath);
+        QString patchError;
+
+        if (!patchFile.open(QIODevice::ReadOnly))
+        {
+            patchError = "Failed to open patch file.";
+        }
+        else if (RomPatch::apply(&patchFile, rom, patchRanges, patchError))
+        {
+            continue;
+        }
+
+        rom.close();
+        patchRanges.clear();
+        sourceFingerprint = RomFingerprint();
+        sourceHashed = false;
+        setError(QFileInfo(patchPath).fileName() + ": " + patchError);
+        return false;
+    }
+
+    // Patched bytes differ from the file on disk, so they are saved (and
+    // exported in patches) like any other edit, but cannot be undone.
+    // Saving over the base file is refused, see prepareSave().
+    appliedPatchCount = patchPaths.size();
+
+    for (const ByteRange &range : patchRanges.ranges())
+    {
+        dirtyRanges.add(range.offset, range.length);
+    }
+
+    mapper = AddressMapper(mapper.mode(), rom.size());
+
+    // Patches may resize the ROM, so any sum is taken again on first use.
+    if (!patchPaths.isEmpty())
+    {
+        romChecksum = SnesChecksum();
+    }
+
+    return true;
+}
+
+
+
+bool PaletteEngine::isLoading() const
+{
+    return rom.isOpen() && !rom.isComplete();
+}
+
+qsizetype PaletteEngine::loadedSize() const
+{
+    return rom.loadedSize();
+}
+
+const RomFingerprint &PaletteEngine::fingerprint() const
+{
+    if (!sourceHashed && rom.isOpen())
+    {
+        hashSourceFile();
+    }
+
+    return sourceFingerprint;
+}
+
+
+
+void PaletteEngine::resetSourceHash() const
+{
+    sourceCrc = 0;
+    headerlessCrc = 0;
+    sourceSha1.reset();
+    headerlessSha1.reset();
+    hashedSize = 0;
+}
+
+
+
+// Chunks must come front to back. SHA-1 cannot be split up, so it runs on
+// a second thread while this one does the CRCs.
+void PaletteEngine::hashSourceChunk(QByteArrayView chunk) const
+{
+    const qsizetype header = sourceHeaderSize;
+    const QByteArrayView headerless = chunk.sliced(qBound<qsizetype>(0, header - hashedSize, chunk.size()));
+
+    QFuture<void> hashing = QtConcurrent::run([this, chunk, headerless, header]
+    {
+        sourceSha1.addData(chunk);
+
+        if (header > 0)
+        {
+            headerlessSha1.addData(headerless);
+        }
+    });
+
+    sourceCrc = crc32(chunk, sourceCrc);
+
+    if (header > 0)
+    {
+        headerlessCrc = crc32(headerless, headerlessCrc);
+    }
+
+    hashing.waitForFinished();
+    hashedSize += chunk.size();
+}
+
+
+
+void PaletteEngine::finishSourceHash() const
+{
+    const qsizetype header = sourceHeaderSize;
+
+    sourceFingerprint.size = sourceSize;
+    sourceFingerprint.copierHeader = header;
+    sourceFingerprint.crc32 = sourceCrc;
+    sourceFingerprint.sha1 = sourceSha1.result();
+    sourceFingerprint.headerlessCrc32 = header > 0 ? headerlessCrc : sourceCrc;
+    sourceFingerprint.headerlessSha1 = header > 0 ? headerlessSha1.result() : sourceFingerprint.sha1;
+    sourceHashed = true;
+}
+
+
+
+// For ROMs opened with openRom(). The file is read again rather than the
+// ROM, which may be patched or edited by now, and without mapping it, so
+// opening a ROM to look up its bookmarks does not keep the whole file
+// resident.
+void PaletteEngine::hashSourceFile() const
+{
+    QFile sourceFile(rom.filePath());
+
+    sourceHashed = true;
+    resetSourceHash();
+
+    if (!sourceFile.open(QIODevice::ReadOnly) || sourceFile.size() != sourceSize)
+    {
+        return;
+    }
+
+    while (hashedSize < sourceSize)
+    {
+        const QByteArray chunk = sourceFile.read(romIoChunkSize);
+
+        if (chunk.isEmpty())
+        {
+            return;
+        }
+
+        hashSourceChunk(chunk);
+    }
+
+    finishSourceHash();
+}
+
+
+
+// Once taken, the sum is kept up to date by every edit; until then edits
+// leave it alone, since it is taken from the current bytes anyway.
+void PaletteEngine::sumChecksum() const
+{
+    if (romChecksum.isEmpty())
+    {
+        romChecksum.reset(rom.size(), mapper.headerSize());
+        romChecksum.add(0, rom.view(0, rom.size()));
+    }
+}
+
+
+
+bool PaletteEngine::saveRom()
+{
+    return saveTo(QString());
+}
+
+
+
+bool PaletteEngine::saveRomAs(const QString &filePath)
+{
+    if (filePath.isEmpty())
+    {
+        setError("No ROM path provided.");
+        return false;
+    }
+
+    return saveTo(filePath);
+}
+
+
+
+bool PaletteEngine::saveTo(const QString &filePath)
+{
+    RomSaveJob job;
+    QString writeError;
+
+    if (!prepareSave(filePath, job))
+    {
+        return false;
+    }
+
+    if (!writeRomFile(job, writeError))
+    {
+        setError(writeError);
+        return false;
+    }
+
+    commitSave(job);
+    return true;
+}
+
+
+
+bool PaletteEngine::prepareSave(const QString &filePath, RomSaveJob &job)
+{
+    if (!rom.isOpen())
+    {
+        setError("No ROM loaded.");
+        return false;
+    }
+
+    if (!rom.isComplete())
+    {
+        setError("ROM is still loading.");
+        return false;
+    }
+
+    job = RomSaveJob();
+    job.filePath = filePath.isEmpty() ? rom.filePath() : filePath;
+
+    if (job.filePath.isEmpty())
+    {
+        setError("No ROM path provided.");
+        return false;
+    }
+
+    const QFileInfo targetInfo(job.filePath);
+
+    job.romData = rom.view(0, rom.size());
+    job.inPlace = targetInfo == QFileInfo(rom.filePath());
+
+    // The base ROM stays clean, so later BPS source checks keep matching.
+    if (job.inPlace && appliedPatchCount > 0)
+    {
+        setError("ROM was opened with patches; use Save As to keep the base ROM unpatched.");
+        return false;
+    }
+
+    // The fingerprint describes the file as opened, so take it before the
+    // file changes.
+    if (job.inPlace)
+    {
+        fingerprint();
+    }
+
+    // In place only the modified ranges are rewritten, without truncating
+    // the file since the ROM is still mapped from it.
+    job.wholeFile = !job.inPlace || !targetInfo.exists() || targetInfo.size() != rom.size();
+
+    if (updateChecksumOnSave)
+    {
+        prepareHeaderChecksum(job);
+    }
+
+    if (!job.wholeFile)
+    {
+        ByteRangeSet ranges = dirtyRanges;
+
+        if (job.checksumOffset >= 0)
+        {
+            ranges.add(job.checksumOffset, job.checksumField.size());
+        }
+
+        job.ranges = ranges.ranges();
+    }
+
+    return true;
+}
+
+
+
+// Writes romData[offset, offset + count) with the job's checksum field laid
+// over it; only the chunk holding the field is copied.
+static bool writeJobBytes(QFileDevice &file, const RomSaveJob &job, qint64 offset, qint64 count)
+{
+    const char *data = job.romData.data() + offset;
+    const qint64 fieldEnd = job.checksumOffset + job.checksumField.size();
+
+    if (job.checksumOffset < 0 || fieldEnd <= offset || job.checksumOffset >= offset + count)
+    {
+        return file.write(data, count) == count;
+    }
+
+    QByteArray bytes(data, count);
+    const qint64 first = qMax(offset, qint64(job.checksumOffset));
+    const qint64 end = qMin(offset + count, fieldEnd);
+
+    memcpy(bytes.data() + (first - offset), job.checksumField.constData() + (first - job.checksumOffset), end - first);
+    return file.write(bytes) == count;
+}
+
+
+
+// A whole file goes to a temporary file next to the target that is renamed
+// over it, so a failed or canceled save never leaves a half written ROM.
+bool PaletteEngine::writeRomFile(const RomSaveJob &job, QString &errorString, const std::function<bool(qint64, qint64)> &progress)
+{
+    if (job.wholeFile)
+    {
+        QSaveFile outputRomFile(job.filePath);
+        const qint64 total = job.romData.size();
+
+        if (!outputRomFile.open(QIODevice::WriteOnly))
+        {
+            errorString = "Failed to save ROM.";
+            return false;
+        }
+
+        for (qint64 offset = 0; offset < total; offset += romIoChunkSize)
+        {
+            const qint64 count = qMin<qint64>(romIoChunkSize, total - offset);
+
+            if (!writeJobBytes(outputRomFile, job, offset, count))
+            {
+                errorString = "Failed to save ROM.";
+                return false;
+            }
+
+            if (progress && !progress(offset + count, total))
+            {
+                errorString = "Saving was canceled.";
+                return false;
+            }
+        }
+
+        if (!outputRomFile.commit())
+        {
+            errorString = "Failed to save ROM.";
+            return false;
+        }
+
+        return true;
+    }
+
+    QFile outputRomFile(job.filePath);
+    qint64 total = 0;
+    qint64 written = 0;
+
+    for (const ByteRange &range : job.ranges)
+    {
+        total += range.length;
+    }
+
+    if (!outputRomFile.open(QIODevice::ReadWrite))
+    {
+        errorString = "Failed to save ROM.";
+        return false;
+    }
+
+    for (const ByteRange &range : job.ranges)
+    {
+        if (!outputRomFile.seek(range.offset) || !writeJobBytes(outputRomFile, job, range.offset, range.length))
+        {
+            errorString = "Failed to save ROM.";
+            return false;
+        }
+
+        written += range.length;
+
+        if (progress && !progress(written, total))
+        {
+            errorString = "Saving was canceled.";
+            return false;
+        }
+    }
+
+    if (!outputRomFile.flush())
+    {
+        errorString = "Failed to save ROM.";
+        return false;
+    }
+
+    return true;
+}
+
+
+
+// Only sets the job's field when the stored one is out of date.
+void PaletteEngine::prepareHeaderChecksum(RomSaveJob &job) const
+{
+    const QByteArrayView romData = rom.view(0, rom.size());
+    const qsizetype headerOffset = romChecksum.headerOffset(mapper.mode(), romData);
+
+    if (headerOffset < 0)
+    {
+        return;
+    }
+
+    sumChecksum();
+
+    const qsizetype fieldOffset = headerOffset + SnesChecksum::fieldOffset;
+    const QByteArray field = SnesChecksum::checksumField(romChecksum.checksum(romData, headerOffset));
+
+    if (romData.sliced(fieldOffset, SnesChecksum::fieldSize) != field)
+    {
+        job.checksumOffset = fieldOffset;
+        job.checksumField = field;
+    }
+}
+
+
+
+// The checksum is not journaled: like patched bytes it follows from the
+// rest of the ROM, so an undo just leaves it to be rewritten on the next
+// save.
+void PaletteEngine::commitSave(const RomSaveJob &job)
+{
+    if (job.checksumOffset >= 0)
+    {
+        const qsizetype fieldSize = job.checksumField.size();
+
+        romChecksum.replace(job.checksumOffset, rom.view(job.checksumOffset, fieldSize), job.checksumField);
+        memcpy(rom.data() + job.checksumOffset, job.checksumField.constData(), fieldSize);
+
+        dirtyRanges.add(job.checksumOffset, fieldSize);
+        patchRanges.add(job.checksumOffset, fieldSize);
+        searchIndex.clear();
+    }
+
+    if (job.inPlace)
+    {
+        dirtyRanges.clear();
+    }
+}
+
+
+
+void PaletteEngine::closeRom()
+{
+    rom.close();
+    dirtyRanges.clear();
+    journal.clear();
+    patchRanges.clear();
+    searchIndex.clear();
+    pendingPatchPaths.clear();
+    appliedPatchCount = 0;
+    sourceFingerprint = RomFingerprint();
+    sourceHashed = false;
+    romChecksum = SnesChecksum();
+}
+
+
+
+uchar *PaletteEngine::beginEdit(quint32 offset, quint32 length)
+{
+    pendingEdit.offset = offset;
+    pendingEdit.length = length;
+    pendingOriginal = QByteArray(reinterpret_cast<const char *>(rom.constData()) + offset, length);
+    return rom.data() + offset;
+}
+
+
+
+// Edits made between beginEditGroup() and endEditGroup() are undone and
+// redone as one step.
+void PaletteEngine::beginEditGroup()
+{
+    editGroupOpen = true;
+    editGroupRecorded = false;
+}
+
+void PaletteEngine::endEditGroup()
+{
+    editGroupOpen = false;
+    editGroupRecorded = false;
+}
+
+
+
+void PaletteEngine::endEdit()
+{
+    const QByteArrayView edited(rom.constData() + pendingEdit.offset, pendingEdit.length);
+    const ByteRange changed = journal.record(pendingEdit.offset, pendingOriginal, edited, editGroupOpen && editGroupRecorded);
+
+    if (changed.length > 0 && editGroupOpen)
+    {
+        editGroupRecorded = true;
+    }
+
+    dirtyRanges.add(changed.offset, changed.length);
+    patchRanges.add(changed.offset, changed.length);
+    if (!romChecksum.isEmpty())
+    {
+        romChecksum.replace(pendingEdit.offset, pendingOriginal, edited);
+    }
+
+    pendingEdit = ByteRange();
+    pendingOriginal.clear();
+
+    if (changed.length > 0)
+    {
+        searchIndex.clear();
+    }
+}
+
+
+
+// Smallest range covering both; an empty range covers nothing.
+static void uniteRange(ByteRange &range, const ByteRange &other)
+{
+    if (range.length == 0)
+    {
+        range = other;
+        return;
+    }
+
+    const qsizetype end = qMax(range.end(), other.end());
+    range.offset = qMin(range.offset, other.offset);
+    range.length = end - range.offset;
+}
+
+
+
+void PaletteEngine::applyDelta(quint32 offset, const QByteArray &bytes, ByteRange &changedRange)
+{
+    if (!romChecksum.isEmpty())
+    {
+        romChecksum.replace(offset, rom.view(offset, bytes.size()), bytes);
+    }
+
+    memcpy(rom.data() + offset, bytes.constData(), bytes.size());
+    dirtyRanges.add(offset, bytes.size());
+    patchRanges.add(offset, bytes.size());
+    searchIndex.clear();
+    changedRange = { offset, bytes.size() };
+}
+
+
+
+bool PaletteEngine::canUndo() const
+{
+    return journal.canUndo();
+}
+
+bool PaletteEngine::canRedo() const
+{
+    return journal.canRedo();
+}
+
+bool PaletteEngine::undo(ByteRange &changedRange)
+{
+    if (!journal.canUndo())
+    {
+        setError("Nothing to undo.");
+        return false;
+    }
+
+    bool joined;
+    changedRange = ByteRange();
+
+    do
+    {
+        const EditDelta &delta = journal.undo();
+        ByteRange deltaRange;
+        applyDelta(delta.offset, delta.before, deltaRange);
+        uniteRange(changedRange, deltaRange);
+        joined = delta.joined;
+    }
+    while (joined && journal.canUndo());
+
+    return true;
+}
+
+bool PaletteEngine::redo(ByteRange &changedRange)
+{
+    if (!journal.canRedo())
+    {
+        setError("Nothing to redo.");
+        return false;
+    }
+
+    changedRange = ByteRange();
+
+    do
+    {
+        const EditDelta &delta = journal.redo();
+        ByteRange deltaRange;
+        applyDelta(delta.offset, delta.after, deltaRange);
+        uniteRange(changedRange, deltaRange);
+    }
+    while (journal.nextRedoJoined());
+
+    return true;
+}
+
+const EditJournal &PaletteEngine::editJournal() const
+{
+    return journal;
+}
+
+
+
+QList<PaletteMatch> PaletteEngine::findPalettes(const QList<PaletteQuery> &queries)
+{
+    const QByteArrayView romData = rom.view(0, rom.size());
+
+    if (searchIndex.isEmpty())
+    {
+        searchIndex.build(romData);
+    }
+
+    return searchIndex.find(romData, queries);
+}
+
+
+
+bool PaletteEngine::exportPatch(const QString &patchPath, PatchFormat format)
+{
+    if (!rom.isOpen())
+    {
+        setError("No ROM loaded.");
+        return false;
+    }
+
+    QSaveFile patchFile(patchPath);
+
+    if (!patchFile.open(QIODevice::WriteOnly))
+    {
+        setError("Failed to open patch file for writing.");
+        return false;
+    }
+
+    const QByteArrayView target = rom.view(0, rom.size());
+    QString patchError;
+    bool written;
+
+    if (format == PatchFormat::Bps)
+    {
+        if (!fingerprint().isValid())
+        {
+            patchFile.cancelWriting();
+            setError("Failed to read the source ROM for its BPS checksum.");
+            return false;
+        }
+
+        written = RomPatch::writeBps(&patchFile, sourceSize, fingerprint().crc32, target, patchRanges, patchError);
+    }
+    else
+    {
+        written = RomPatch::writeIps(&patchFile, target, patchRanges, patchError);
+    }
+
+    if (!written)
+    {
+        patchFile.cancelWriting();
+        setError(patchError);
+        return false;
+    }
+
+    if (!patchFile.commit())
+    {
+        setError("Failed to write patch file.");
+        return false;
+    }
+
+    return true;
+}
+
+
+
+const ByteRangeSet &PaletteEngine::modifiedRanges() const
+{
+    return dirtyRanges;
+}
+
+bool PaletteEngine::isModified() const
+{
+    return !dirtyRanges.isEmpty();
+}
+
+
+
+bool PaletteEngine::isLoaded() const
+{
+    return rom.isOpen();
+}
+
+bool PaletteEngine::isPatched() const
+{
+    return appliedPatchCount > 0;
+}
+
+QString PaletteEngine::filePath() const
+{
+    return rom.filePath();
+}
+
+const RomStorage &PaletteEngine::storage() const
+{
+    return rom;
+}
+
+quint32 PaletteEngine::size() const
+{
+    return rom.size();
+}
+
+QString PaletteEngine::errorString() const
+{
+    return lastError;
+}
+
+void PaletteEngine::setError(const QString &message)
+{
+    lastError = message;
+}
+
+
+
+bool PaletteEngine::isValidRange(quint32 address, quint32 length) const
+{
+    return rom.contains(address, length);
+}
+
+
+
+bool PaletteEngine::checkRange(const PaletteSettings &settings, quint32 &fileOffset)
+{
+    if (!rom.isOpen())
+    {
+        setError("No ROM loaded.");
+        return false;
+    }
+
+    if (!toFileOffset(settings.address, settings.busAddress, fileOffset))
+    {
+        setError("Address is not mapped to ROM.");
+        return false;
+    }
+
+    if (!isValidRange(fileOffset, settings.colorCount * 2))
+    {
+        if (isLoading() && qint64(fileOffset) + settings.colorCount * 2 <= rom.size())
+        {
+            setError("ROM data not loaded yet.");
+        }
+        else
+        {
+            setError("Invalid palette address.");
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+
+
+bool PaletteEngine::toFileOffset(quint32 address, bool busAddress, quint32 &fileOffset) const
+{
+    if (!busAddress)
+    {
+        fileOffset = address;
+        return true;
+    }
+
+    return mapper.busToFile(address, fileOffset);
+}
+
+
+
+bool PaletteEngine::toBusAddress(quint32 fileOffset, quint32 &busAddress) const
+{
+    return mapper.fileToBus(fileOffset, busAddress);
+}
+
+
+
+bool PaletteEngine::headerChecksum(quint16 &stored, quint16 &computed) const
+{
+    if (!rom.isOpen() || !rom.isComplete())
+    {
+        return false;
+    }
+
+    const QByteArrayView romData = rom.view(0, rom.size());
+    const qsizetype headerOffset = romChecksum.headerOffset(mapper.mode(), romData);
+
+    if (headerOffset < 0)
+    {
+        return false;
+    }
+
+    sumChecksum();
+    stored = SnesChecksum::storedChecksum(romData, headerOffset);
+    computed = romChecksum.checksum(romData, headerOffset);
+    return true;
+}
+
+void PaletteEngine::setChecksumUpdate(bool enabled)
+{
+    updateChecksumOnSave = enabled;
+}
+
+bool PaletteEngine::checksumUpdate() const
+{
+    return updateChecksumOnSave;
+}
+
+
+
+void PaletteEngine::setAddressMapMode(AddressMapMode mode)
+{
+    mapper = AddressMapper(mode, rom.size());
+}
+
+AddressMapMode PaletteEngine::addressMapMode() const
+{
+    return mapper.mode();
+}
+
+const AddressMapper &PaletteEngine::addressMapper() const
+{
+    return mapper;
+}
+
+
+
+void PaletteEngine::setColorQuantization(ColorQuantization mode)
+{
+    quantization = mode;
+}
+
+ColorQuantization PaletteEngine::colorQuantization() const
+{
+    return quantization;
+}
+
+
+
+bool PaletteEngine::getPaletteBinFromROM(const PaletteSettings &settings, QByteArrayView &paletteData)
+{
+    quint32 fileOffset;
+
+    if (!checkRange(settings, fileOffset))
+    {
+        return false;
+    }
+
+    paletteData = rom.view(fileOffset, settings.colorCount * 2);
+    return true;
+}
+
+
+
+QImage PaletteEngine::getImageFromBin(QByteArrayView paletteData, const PaletteSettings &settings)
+{
+    QImage paletteImage;
+    decodePaletteImage(paletteData, settings, paletteImage);
+    return paletteImage;
+}
+
+
+
+// Decodes into an existing image when its size already matches, so callers
+// that decode many palettes of the same layout reuse one buffer.
+void PaletteEngine::decodePaletteImage(QByteArrayView paletteData, const PaletteSettings &settings, QImage &paletteImage)
+{
+    quint32 colorCount = qMin<quint32>(settings.colorCount, paletteData.size() / 2);
+    quint32 rowWidth = qMax<quint32>(settings.rowWidth, 1);
+    quint32 paletteImageWidth;
+    quint32 paletteImageHeight;
+
+    if (colorCount == 0)
+    {
+        paletteImage = QImage();
+        return;
+    }
+
+    if (colorCount < rowWidth)
+    {
+        paletteImageWidth = colorCount;
+        paletteImageHeight = 1;
+    }
+    else
+    {
+        paletteImageWidth = rowWidth;
+        paletteImageHeight = (colorCount + rowWidth - 1) / rowWidth;
+    }
+
+    QSize paletteImageSize(paletteImageWidth, paletteImageHeight);
+
+    if (paletteImage.size() != paletteImageSize || paletteImage.format() != QImage::Format_RGB32)
+    {
+        paletteImage = QImage(paletteImageSize, QImage::Format_RGB32);
+    }
+
+    paletteImage.fill(Qt::white);
+
+    const uchar *snesData = reinterpret_cast<const uchar *>(paletteData.data());
+
+    for (quint32 y = 0; y < paletteImageHeight; y++)
+    {
+        quint32 first = y * rowWidth;
+        quint32 count = qMin(rowWidth, colorCount - first);
+        snesToRGBBulk(snesData + first * 2, reinterpret_cast<QRgb *>(paletteImage.scanLine(y)), count);
+    }
+}
+
+
+
+bool PaletteEngine::getPaletteImage(const PaletteSettings &settings, QImage &image)
+{
+    QByteArrayView paletteData;
+
+    if (!getPaletteBinFromROM(settings, paletteData))
+    {
+        return false;
+    }
+
+    image = getImageFromBin(paletteData, settings);
+    return true;
+}
+
+
+
+// Converts the first colorCount pixels of a decoded band that starts at
+// image row firstRow into SNES colors. Indexed images go through a converted
+// color table so no per-pixel RGB conversion is needed, unless dithering
+// makes the result depend on the pixel position; everything else is
+// converted to ARGB32 at most once.
+static void bandToSNES(QImage band, quint32 firstRow, quint32 colorCount, ColorQuantization mode, uchar *snesData)
+{
+    const quint32 width = band.width();
+
+    if (band.format() == QImage::Format_Indexed8 && mode != ColorQuantization::OrderedDither)
+    {
+        QList<QRgb> colorTable = band.colorTable();
+        colorTable.resize(256, qRgb(0, 0, 0));
+
+        uchar snesTable[256 * 2];
+        quantizeToSNES(colorTable.constData(), snesTable, 256, mode);
+
+        for (quint32 y = 0; y * width < colorCount; y++)
+        {
+            const uchar *line = band.constScanLine(y);
+            quint32 count = qMin(width, colorCount - y * width);
+            uchar *out = snesData + y * width * 2;
+
+            for (quint32 x = 0; x < count; x++)
+            {
+                out[x * 2] = snesTable[line[x] * 2];
+                out[x * 2 + 1] = snesTable[line[x] * 2 + 1];
+            }
+        }
+
+        return;
+    }
+
+    if (band.format() != QImage::Format_RGB32 && band.format() != QImage::Format_ARGB32)
+    {
+        band.convertTo(QImage::Format_ARGB32);
+    }
+
+    for (quint32 y = 0; y * width < colorCount; y++)
+    {
+        quint32 first = y * width;
+        quint32 count = qMin(width, colorCount - first);
+        quantizeToSNES(reinterpret_cast<const QRgb *>(band.constScanLine(y)), snesData + first * 2, count, mode, 0, firstRow + y);
+    }
+}
+
+
+
+// Images are read once through QImageReader. Formats whose handler supports
+// clipped reads only decode the rows holding the imported colors; others
+// (PNG, BMP) decode the whole image. Either way only those rows are
+// converted, straight into the ROM buffer.
+bool PaletteEngine::importImage(const QString &imagePath, PaletteSettings &settings, bool colorCountFromImport)
+{
+    QImageReader reader(imagePath);
+    const QSize imageSize = reader.size();
+
+    if (!reader.canRead() || imageSize.isEmpty())
+    {
+        setError("Failed to open image file.");
+        return false;
+    }
+
+    quint32 imageColorCount = quint32(imageSize.width()) * quint32(imageSize.height());
+
+    settings.rowWidth = imageSize.width();
+
+    if (colorCountFromImport == true || imageColorCount < settings.colorCount)
+    {
+        settings.colorCount = imageColorCount;
+    }
+
+    quint32 fileOffset;
+
+    if (!checkRange(settings, fileOffset))
+    {
+        return false;
+    }
+
+    const quint32 rowCount = (settings.colorCount + settings.rowWidth - 1) / settings.rowWidth;
+
+    if (reader.supportsOption(QImageIOHandler::ClipRect))
+    {
+        reader.setClipRect(QRect(0, 0, settings.rowWidth, rowCount));
+    }
+
+    // Decoded before the ROM is touched, so a broken file changes nothing.
+    const QImage image = reader.read();
+
+    if (image.isNull())
+    {
+        setError("Failed to decode image file: " + reader.errorString());
+        return false;
+    }
+
+    bandToSNES(image, 0, settings.colorCount, quantization, beginEdit(fileOffset, settings.colorCount * 2));
+    endEdit();
+    return true;
+}
+
+
+
+bool PaletteEngine::importPal(const QString &palPath, PaletteSettings &settings, bool colorCountFromImport)
+{
+    QFile palFile(palPath);
+
+    if (!palFile.open(QIODevice::ReadOnly))
+    {
+        setError("Failed to open .pal file.");
+        return false;
+    }
+
+    QByteArray palData = palFile.readAll();
+    quint32 palColorCount = palData.size() / 3;
+    palFile.close();
+
+    if (colorCountFromImport == true || palColorCount < settings.colorCount)
+    {
+        settings.colorCount = palColorCount;
+    }
+
+    quint32 fileOffset;
+
+    if (!checkRange(settings, fileOffset))
+    {
+        return false;
+    }
+
+    const uchar *rgbData = reinterpret_cast<const uchar *>(palData.constData());
+    uchar *snesData = beginEdit(fileOffset, settings.colorCount * 2);
+
+    // Rows of rowWidth colors give ordered dithering its pixel positions.
+    for (quint32 y = 0; y * settings.rowWidth < settings.colorCount; y++)
+    {
+        quint32 first = y * settings.rowWidth;
+        quint32 count = qMin(settings.rowWidth, settings.colorCount - first);
+        quantizeRGB888ToSNES(rgbData + first * 3, snesData + first * 2, count, quantization, 0, y);
+    }
+
+    endEdit();
+
+    return true;
+}
+
+
+
+bool PaletteEngine::importTiledImage(const QString &imagePath, PaletteSettings &settings, quint32 subPaletteCount)
+{
+    if (subPaletteCount == 0 || subPaletteCount > 256)
+    {
+        setError("Invalid sub-palette count.");
+        return false;
+    }
+
+    QImageReader reader(imagePath);
+    QImage sheet = reader.read();
+
+    if (sheet.isNull())
+    {
+        setError("Failed to open image file.");
+        return false;
+    }
+
+    TileQuantizeOptions options;
+    options.subPaletteCount = subPaletteCount;
+    options.quantization = quantization;
+
+    settings.rowWidth = options.colorsPerSubPalette;
+    settings.colorCount = subPaletteCount * options.colorsPerSubPalette;
+
+    quint32 fileOffset;
+
+    if (!checkRange(settings, fileOffset))
+    {
+        return false;
+    }
+
+    TileQuantizeResult result;
+
+    if (!TileQuantizer::quantize(sheet, options, result))
+    {
+        setError("Failed to quantize image.");
+        return false;
+    }
+
+    uchar *snesData = beginEdit(fileOffset, settings.colorCount * 2);
+
+    for (quint32 i = 0; i < settings.colorCount; i++)
+    {
+        if (i % options.colorsPerSubPalette == 0)
+        {
+            continue;
+        }
+
+        snesData[i * 2] = result.colors.at(i) & 0xFF;
+        snesData[i * 2 + 1] = result.colors.at(i) >> 8;
+    }
+
+    endEdit();
+
+    return true;
+}
+
+
+
+bool PaletteEngine::importBin(const QString &binPath, PaletteSettings &settings, bool colorCountFromImport)
+{
+    QFile binFile(binPath);
+
+    if (!binFile.open(QIODevice::ReadOnly))
+    {
+        setError("Failed to open palette data file.");
+        return false;
+    }
+
+    QByteArray binData = binFile.readAll();
+    quint32 binColorCount = binData.size() / 2;
+    binFile.close();
+
+    if (colorCountFromImport == true || binColorCount < settings.colorCount)
+    {
+        settings.colorCount = binColorCount;
+    }
+
+    quint32 fileOffset;
+
+    if (!checkRange(settings, fileOffset))
+    {
+        return false;
+    }
+
+    memcpy(beginEdit(fileOffset, settings.colorCount * 2), binData.constData(), settings.colorCount * 2);
+    endEdit();
+    return true;
+}
+
+
+
+// One manifest entry between validation and the write pass.
+struct ManifestJob
+{
+    const ManifestEntry *entry = nullptr;
+    quint32 fileOffset = 0;
+    quint32 colorCount = 0;
+    quint32 rowWidth = 0;
+    ColorQuantization quantization = ColorQuantization::Truncate;
+    QByteArray snesData;
+    QString error;
+};
+
+static void decodeManifestJob(ManifestJob &job)
+{
+    job.snesData.resize(job.colorCount * 2);
+    uchar *snesData = reinterpret_cast<uchar *>(job.snesData.data());
+
+    if (job.entry->format == PaletteFileFormat::Image)
+    {
+        QImageReader reader(job.entry->filePath);
+        QImage image = reader.read();
+
+        if (image.isNull())
+        {
+            job.error = "Failed to decode image file: " + reader.errorString();
+            return;
+        }
+
+        bandToSNES(image, 0, job.colorCount, job.quantization, snesData);
+        return;
+    }
+
+    QFile paletteFile(job.entry->filePath);
+    const qsizetype bytesPerColor = job.entry->format == PaletteFileFormat::Pal ? 3 : 2;
+    QByteArray fileData;
+
+    if (paletteFile.open(QIODevice::ReadOnly))
+    {
+        fileData = paletteFile.read(job.colorCount * bytesPerColor);
+    }
+
+    if (fileData.size() != job.colorCount * bytesPerColor)
+    {
+        job.error = "Failed to read palette file.";
+        return;
+    }
+
+    if (job.entry->format == PaletteFileFormat::Bin)
+    {
+        memcpy(snesData, fileData.constData(), fileData.size());
+        return;
+    }
+
+    const uchar *rgbData = reinterpret_cast<const uchar *>(fileData.constData());
+
+    for (quint32 y = 0; y * job.rowWidth < job.colorCount; y++)
+    {
+        quint32 first = y * job.rowWidth;
+        quint32 count = qMin(job.rowWidth, job.colorCount - first);
+        quantizeRGB888ToSNES(rgbData + first * 3, snesData + first * 2, count, job.quantization, 0, y);
+    }
+}
+
+
+
+// Checks an entry's file, color count and range, leaving the error without
+// the manifest line number.
+bool PaletteEngine::prepareManifestJob(const ManifestEntry &entry, ManifestJob &job)
+{
+    job.entry = &entry;
+    job.quantization = quantization;
+    job.rowWidth = entry.settings.rowWidth > 0 ? entry.settings.rowWidth : 16;
+
+    QFileInfo fileInfo(entry.filePath);
+    quint32 fileColorCount = 0;
+
+    if (!fileInfo.isReadable())
+    {
+        setError(QString("Failed to open %1.").arg(fileInfo.fileName()));
+        return false;
+    }
+
+    if (entry.format == PaletteFileFormat::Image)
+    {
+        const QSize imageSize = QImageReader(entry.filePath).size();
+
+        if (imageSize.isEmpty())
+        {
+            setError(QString("Failed to open image file %1.").arg(fileInfo.fileName()));
+            return false;
+        }
+
+        fileColorCount = quint32(imageSize.width()) * quint32(imageSize.height());
+        job.rowWidth = imageSize.width();
+    }
+    else
+    {
+        fileColorCount = quint32(fileInfo.size() / (entry.format == PaletteFileFormat::Pal ? 3 : 2));
+    }
+
+    job.colorCount = entry.settings.colorCount > 0 ? entry.settings.colorCount : fileColorCount;
+
+    if (fileColorCount == 0 || job.colorCount > fileColorCount)
+    {
+        setError(QString("%1 holds %2 colors, %3 needed.").arg(fileInfo.fileName()).arg(fileColorCount).arg(job.colorCount));
+        return false;
+    }
+
+    PaletteSettings settings = entry.settings;
+    settings.colorCount = job.colorCount;
+    return checkRange(settings, job.fileOffset);
+}
+
+
+
+bool PaletteEngine::importManifest(const QList<ManifestEntry> &entries)
+{
+    QList<ManifestJob> jobs;
+    jobs.reserve(entries.size());
+
+    for (const ManifestEntry &entry : entries)
+    {
+        ManifestJob job;
+
+        if (!prepareManifestJob(entry, job))
+        {
+            setError(QString("line %1: %2").arg(entry.line).arg(lastError));
+            return false;
+        }
+
+        jobs.append(job);
+    }
+
+    std::sort(jobs.begin(), jobs.end(), [](const ManifestJob &a, const ManifestJob &b)
+    {
+        return a.fileOffset < b.fileOffset;
+    });
+
+    for (qsizetype i = 1; i < jobs.size(); i++)
+    {
+        const ManifestJob &previous = jobs.at(i - 1);
+
+        if (previous.fileOffset + previous.colorCount * 2 > jobs.at(i).fileOffset)
+        {
+            setError(QString("line %1 overlaps line %2.").arg(jobs.at(i).entry->line).arg(previous.entry->line));
+            return false;
+        }
+    }
+
+    QtConcurrent::blockingMap(jobs, decodeManifestJob);
+
+    for (const ManifestJob &job : std::as_const(jobs))
+    {
+        if (!job.error.isEmpty())
+        {
+            setError(QString("line %1: %2").arg(job.entry->line).arg(job.error));
+            return false;
+        }
+    }
+
+    beginEditGroup();
+
+    for (const ManifestJob &job : std::as_const(jobs))
+    {
+        memcpy(beginEdit(job.fileOffset, job.snesData.size()), job.snesData.constData(), job.snesData.size());
+        endEdit();
+    }
+
+    endEditGroup();
+    return true;
+}
+
+
+
+bool PaletteEngine::reimportChangedColors(const ManifestEntry &entry, int &changedColors, ByteRange &changedRange)
+{
+    ManifestJob job;
+    changedColors = 0;
+    changedRange = ByteRange();
+
+    if (!prepareManifestJob(entry, job))
+    {
+        return false;
+    }
+
+    decodeManifestJob(job);
+
+    if (!job.error.isEmpty())
+    {
+        setError(job.error);
+        return false;
+    }
+
+    const uchar *newData = reinterpret_cast<const uchar *>(job.snesData.constData());
+    const uchar *romData = rom.constData() + job.fileOffset;
+    quint32 color = 0;
+
+    auto colorChanged = [&](quint32 index)
+    {
+        return memcmp(newData + index * 2, romData + index * 2, 2) != 0;
+    };
+
+    beginEditGroup();
+
+    // Each run of differing colors is one write.
+    while (color < job.colorCount)
+    {
+        if (!colorChanged(color))
+        {
+            color++;
+            continue;
+        }
+
+        quint32 runEnd = color + 1;
+
+        while (runEnd < job.colorCount && colorChanged(runEnd))
+        {
+            runEnd++;
+        }
+
+        const quint32 runBytes = (runEnd - color) * 2;
+        memcpy(beginEdit(job.fileOffset + color * 2, runBytes), newData + color * 2, runBytes);
+        endEdit();
+
+        changedColors += int(runEnd - color);
+        uniteRange(changedRange, { qsizetype(job.fileOffset + color * 2), qsizetype(runBytes) });
+        color = runEnd;
+    }
+
+    endEditGroup();
+    return true;
+}
+
+
+
+bool PaletteEngine::exportImage(const QString &imagePath, const PaletteSettings &settings)
+{
+    QImage paletteImage;
+
+    if (!getPaletteImage(settings, paletteImage))
+    {
+        return false;
+    }
+
+    if (!paletteImage.save(imagePath))
+    {
+        setError("Failed to save palette to image.");
+        return false;
+    }
+
+    return true;
+}
+
+
+
+bool PaletteEngine::exportPal(const QString &palPath, const PaletteSettings &settings)
+{
+    QByteArrayView paletteData;
+
+    if (!getPaletteBinFromROM(settings, paletteData))
+    {
+        return false;
+    }
+
+    QFile outputPalFile(palPath);
+
+    if (!outputPalFile.open(QIODevice::WriteOnly))
+    {
+        setError("Failed to save pal data.");
+        return false;
+    }
+
+    QByteArray palData(settings.colorCount * 3, Qt::Uninitialized);
+    snesToRGB888Bulk(reinterpret_cast<const uchar *>(paletteData.data()),
+                     reinterpret_cast<uchar *>(palData.data()),
+                     settings.colorCount);
+
+    outputPalFile.write(palData);
+    outputPalFile.close();
+    return true;
+}
+
+
+
+bool PaletteEngine::exportBin(const QString &binPath, const PaletteSettings &settings)
+{
+    quint32 fileOffset;
+
+    if (!checkRange(settings, fileOffset))
+    {
+        return false;
+    }
+
+    QFile outputBinFile(binPath);
+
+    if (!outputBinFile.open(QIODevice::WriteOnly))
+    {
+        setError("Failed to save palette data.");
+        return false;
+    }
+
+    QByteArrayView binData = rom.view(fileOffset, settings.colorCount * 2);
+    outputBinFile.write(binData.data(), binData.size());
+    outputBinFile.close();
+    return true;
+}
+
+
+
+bool PaletteEngine::extractPalette(const PaletteSettings &settings, const QString &directory)
+{
+    int extractedCount;
+    return extractPalettes(QList<PaletteSettings>() << settings, directory, extractedCount);
+}
+
+
+
+// One palette of a bulk extract. The paths and ROM bytes are filled in on
+// the calling thread, the encoded data by encodeExtractedPalette().
+struct ExtractedPalette
+{
+    PaletteSettings settings;
+    QByteArrayView binData;
+    QString pngPath;
+    QString palPath;
+    QString binPath;
+    QByteArray pngData;
+    QByteArray palData;
+};
+
+static ExtractedPalette encodeExtractedPalette(const ExtractedPalette &job)
+{
+    ExtractedPalette palette = job;
+    QBuffer pngBuffer(&palette.pngData);
+
+    if (!pngBuffer.open(QIODevice::WriteOnly)
+        || !PaletteEngine::getImageFromBin(palette.binData, palette.settings).save(&pngBuffer, "PNG"))
+    {
+        palette.pngData.clear();
+    }
+
+    palette.palData.resize(palette.settings.colorCount * 3);
+    snesToRGB888Bulk(reinterpret_cast<const uchar *>(palette.binData.data()),
+                     reinterpret_cast<uchar *>(palette.palData.data()),
+                     palette.settings.colorCount);
+    return palette;
+}
+
+static bool writeExtractedFile(const QString &filePath, QByteArrayView data)
+{
+    QFile outputFile(filePath);
+    return outputFile.open(QIODevice::WriteOnly) && outputFile.write(data.data(), data.size()) == data.size();
+}
+
+
+
+bool PaletteEngine::extractPalettes(const QList<PaletteSettings> &paletteList, const QString &directory, int &extractedCount)
+{
+    QDir outputDir(directory.isEmpty() ? QFileInfo(rom.filePath()).absolutePath() : directory);
+    QList<ExtractedPalette> jobs;
+    extractedCount = 0;
+
+    jobs.reserve(paletteList.size());
+
+    for (const PaletteSettings &settings : paletteList)
+    {
+        ExtractedPalette job;
+        quint32 fileOffset;
+
+        if (!checkRange(settings, fileOffset))
+        {
+            setError(QString("$%1: %2").arg(settings.address, 0, 16).arg(lastError));
+            return false;
+        }
+
+        job.settings = settings;
+        job.binData = rom.view(fileOffset, settings.colorCount * 2);
+        job.pngPath = outputDir.filePath(extractFileName(settings, "png"));
+        job.palPath = outputDir.filePath(extractFileName(settings, "pal"));
+        job.binPath = outputDir.filePath(extractFileName(settings, "bin"));
+        jobs.append(job);
+    }
+
+    if (jobs.isEmpty())
+    {
+        return true;
+    }
+
+    QFuture<ExtractedPalette> encoding = QtConcurrent::mapped(jobs.mid(0, extractBatchSize), encodeExtractedPalette);
+
+    for (qsizetype first = 0; first < jobs.size(); first += extractBatchSize)
+    {
+        const QList<ExtractedPalette> encoded = encoding.results();
+
+        if (first + extractBatchSize < jobs.size())
+        {
+            encoding = QtConcurrent::mapped(jobs.mid(first + extractBatchSize, extractBatchSize), encodeExtractedPalette);
+        }
+
+        for (const ExtractedPalette &palette : encoded)
+        {
+            if (palette.pngData.isEmpty())
+            {
+                setError("Failed to save palette to image.");
+            }
+            else if (!writeExtractedFile(palette.pngPath, palette.pngData)
+                     || !writeExtractedFile(palette.palPath, palette.palData)
+                     || !writeExtractedFile(palette.binPath, palette.binData))
+            {
+                setError("Failed to write " + QFileInfo(palette.pngPath).completeBaseName() + ".");
+            }
+            else
+            {
+                extractedCount++;
+                continue;
+            }
+
+            encoding.waitForFinished();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+
+bool PaletteEngine::paletteRange(const PaletteSettings &first, quint32 endAddress, QList<PaletteSettings> &paletteList)
+{
+    const quint32 step = first.colorCount * 2;
+    quint32 startOffset;
+    quint32 endOffset;
+
+    paletteList.clear();
+
+    if (!rom.isOpen())
+    {
+        setError("No ROM loaded.");
+        return false;
+    }
+
+    if (step == 0)
+    {
+        setError("Invalid color count.");
+        return false;
+    }
+
+    if (!toFileOffset(first.address, first.busAddress, startOffset)
+        || !toFileOffset(endAddress, first.busAddress, endOffset))
+    {
+        setError("Address is not mapped to ROM.");
+        return false;
+    }
+
+    endOffset = qMin<quint32>(endOffset, rom.size());
+
+    for (quint32 fileOffset = startOffset; fileOffset + step <= endOffset; fileOffset += step)
+    {
+        PaletteSettings settings = first;
+        settings.address = fileOffset;
+        settings.busAddress = false;
+
+        if (first.busAddress && toBusAddress(fileOffset, settings.address))
+        {
+            settings.busAddress = true;
+        }
+
+        paletteList.append(settings);
+    }
+
+    if (paletteList.isEmpty())
+    {
+        setError("Address range holds no complete palette.");
+        return false;
+    }
+
+    return true;
+}
+
+
+
+QString PaletteEngine::extractFileName(const PaletteSettings &settings, const QString &suffix) const
+{
+    QFileInfo romInfo(rom.filePath());
+    QString romName = romInfo.fileName();
+    return romName + "-$" + QString::number(settings.address, 16) + "." + suffix;
+}
+
+
+
+QString PaletteEngine::quickExtractPath(const PaletteSettings &settings, const QString &suffix) const
+{
+    QFileInfo romInfo(rom.filePath());
+    QString romFolderPath = romInfo.absolutePath();
+    return romFolderPath + "/" + extractFileName(settings, suffix);
+}
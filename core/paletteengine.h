@@ -0,0 +1,267 @@
+#ifndef PALETTEENGINE_H
+#define PALETTEENGINE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QCryptographicHash>
+#include <QImage>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+#include "addressmapper.h"
+#include "byterangeset.h"
+#include "colorquantizer.h"
+#include "editjournal.h"
+#include "paletteindex.h"
+#include "rompatch.h"
+#include "sneschecksum.h"
+#include "romstorage.h"
+#include "snescolor.h"
+#include "tilequantizer.h"
+
+struct ManifestEntry;
+struct ManifestJob;
+
+// What saveRom()/saveRomAs() write, captured by PaletteEngine::prepareSave()
+// so the file I/O can run on another thread. The ROM must not be edited
+// until the job has been written and committed.
+struct RomSaveJob
+{
+    QString filePath;
+    QByteArrayView romData;
+    bool inPlace = false;
+
+    // Whole file (written atomically) or just these ranges, in place.
+    bool wholeFile = true;
+    QList<ByteRange> ranges;
+
+    // Header checksum field written over romData at checksumOffset (-1 for
+    // none). The ROM itself only takes it in commitSave(), so a refused,
+    // failed or canceled save leaves the ROM as it was.
+    qsizetype checksumOffset = -1;
+    QByteArray checksumField;
+};
+
+// Identifies a ROM file as it was read from disk, before any patches. The
+// headerless hashes skip a 512 byte copier header (copierHeader bytes) and
+// equal the full ones when there is none, so headered and unheadered
+// dumps of one game share them.
+struct RomFingerprint
+{
+    qsizetype size = 0;
+    quint32 copierHeader = 0;
+    quint32 crc32 = 0;
+    QByteArray sha1;
+    quint32 headerlessCrc32 = 0;
+    QByteArray headerlessSha1;
+
+    bool isValid() const { return !headerlessSha1.isEmpty(); }
+};
+
+// Where a palette lives in the ROM and how it is laid out as an image.
+struct PaletteSettings
+{
+    quint32 address = 0;
+    quint32 colorCount = 128;
+    quint32 rowWidth = 16;
+
+    // When set, address is an SNES bus address translated through the
+    // engine's address map mode; otherwise it is a raw file offset.
+    bool busAddress = false;
+};
+
+// GUI-free palette core. Owns one loaded ROM and performs every
+// import/export/extract operation against it, so a single process can run
+// any number of palette jobs without reloading the file. Failing calls
+// return false and leave a description in errorString().
+class PaletteEngine
+{
+public:
+    PaletteEngine();
+
+    // Patches (IPS or BPS) are applied in order on top of the loaded image
+    // without touching the file. A patched ROM can only be saved to
+    // another file (saveRomAs()); saveRom() refuses to overwrite the base.
+    bool openRom(const QString &filePath, const QStringList &patchPaths = QStringList());
+    bool saveRom();
+    bool saveRomAs(const QString &filePath);
+    void closeRom();
+
+    // openRom() in steps, so the reading can run on a worker thread.
+    // beginOpenRom() opens the file; loadRomChunk() then reads it front to
+    // back (returning the new byte count, 0 when done, -1 on error) and
+    // the part read so far is already available to every read-only call.
+    // finishOpenRom() applies the patches once the worker is done. The ROM
+    // must not be edited or saved before that.
+    bool beginOpenRom(const QString &filePath, const QStringList &patchPaths = QStringList());
+    qsizetype loadRomChunk();
+    bool finishOpenRom();
+    bool isLoading() const;
+    qsizetype loadedSize() const;
+
+    // Hashed from the chunks as loadRomChunk() reads them, so it is ready
+    // once a ROM loaded in steps is open. openRom() does not hash; there
+    // it is read from the file on first use, and at the latest before the
+    // file is saved over. Invalid if the file can no longer be read.
+    const RomFingerprint &fingerprint() const;
+
+    // The header checksum sum reads the whole ROM, so openRom() does not
+    // take it. This takes it now, e.g. on the loading thread before
+    // finishOpenRom() when it will be needed anyway.
+    void prepareRomSums();
+
+    // saveRom()/saveRomAs() in steps, so the writing can run on a worker
+    // thread: prepareSave() (an empty path saves in place), writeRomFile()
+    // on any thread, then commitSave(). progress gets the bytes written so
+    // far and the total, and cancels the save by returning false.
+    bool prepareSave(const QString &filePath, RomSaveJob &job);
+    static bool writeRomFile(const RomSaveJob &job, QString &errorString,
+                             const std::function<bool(qint64, qint64)> &progress = nullptr);
+    void commitSave(const RomSaveJob &job);
+
+    bool isLoaded() const;
+    bool isPatched() const;
+    QString filePath() const;
+    const RomStorage &storage() const;
+    quint32 size() const;
+
+    const ByteRangeSet &modifiedRanges() const;
+    bool isModified() const;
+
+    // Multi-level undo of every ROM edit since the ROM was opened. On
+    // success changedRange holds the file bytes that were rewritten.
+    bool canUndo() const;
+    bool canRedo() const;
+    bool undo(ByteRange &changedRange);
+    bool redo(ByteRange &changedRange);
+    const EditJournal &editJournal() const;
+
+    // Every file offset where each query's colors occur exactly. The search
+    // index is built on first use and rebuilt after the ROM changes.
+    QList<PaletteMatch> findPalettes(const QList<PaletteQuery> &queries);
+
+    // Writes a patch from the ROM as it was opened to its current contents.
+    // It covers every range edited since then; saving does not reset them.
+    bool exportPatch(const QString &patchPath, PatchFormat format);
+
+    // Internal header checksum of the ROM as it is now and as stored in
+    // the header. Returns false when the ROM has no header location for
+    // the current address map mode. It is kept current on every edit, and
+    // when enabled, saving writes it (with its complement) into the header.
+    bool headerChecksum(quint16 &stored, quint16 &computed) const;
+    void setChecksumUpdate(bool enabled);
+    bool checksumUpdate() const;
+
+    bool isValidRange(quint32 address, quint32 length) const;
+
+    void setAddressMapMode(AddressMapMode mode);
+    AddressMapMode addressMapMode() const;
+    const AddressMapper &addressMapper() const;
+    bool toFileOffset(quint32 address, bool busAddress, quint32 &fileOffset) const;
+    bool toBusAddress(quint32 fileOffset, quint32 &busAddress) const;
+
+    // How image and .pal imports reduce RGB to BGR555.
+    void setColorQuantization(ColorQuantization mode);
+    ColorQuantization colorQuantization() const;
+
+    bool getPaletteBinFromROM(const PaletteSettings &settings, QByteArrayView &paletteData);
+    static QImage getImageFromBin(QByteArrayView paletteData, const PaletteSettings &settings);
+    static void decodePaletteImage(QByteArrayView paletteData, const PaletteSettings &settings, QImage &paletteImage);
+    bool getPaletteImage(const PaletteSettings &settings, QImage &image);
+
+    bool importImage(const QString &imagePath, PaletteSettings &settings, bool colorCountFromImport);
+    bool importPal(const QString &palPath, PaletteSettings &settings, bool colorCountFromImport);
+    bool importBin(const QString &binPath, PaletteSettings &settings, bool colorCountFromImport);
+
+    // Quantizes a full-color sprite sheet into subPaletteCount 16 color
+    // sub-palettes, one per 8x8 tile (see TileQuantizer), and writes them
+    // as consecutive rows at settings.address. Color 0 of every row is left
+    // as it is in the ROM.
+    bool importTiledImage(const QString &imagePath, PaletteSettings &settings, quint32 subPaletteCount);
+
+    // Imports every entry of an import manifest (see ImportManifest) as one
+    // undo step. Files, ranges and overlaps between entries are all checked
+    // first, the files are then decoded in parallel, and the ROM is only
+    // written once every entry decoded, in a single pass.
+    bool importManifest(const QList<ManifestEntry> &entries);
+
+    // Imports one file again after it changed on disk (see
+    // PaletteFileWatcher). Only colors that differ from the ROM are
+    // written, as one undo step; changedRange covers them and is empty,
+    // like changedColors, when none differ.
+    bool reimportChangedColors(const ManifestEntry &entry, int &changedColors, ByteRange &changedRange);
+
+    bool exportImage(const QString &imagePath, const PaletteSettings &settings);
+    bool exportPal(const QString &palPath, const PaletteSettings &settings);
+    bool exportBin(const QString &binPath, const PaletteSettings &settings);
+
+    // Writes the palette as .png, .pal and .bin using the quick extract
+    // naming (romName-$address.ext), into the ROM's folder by default.
+    bool extractPalette(const PaletteSettings &settings, const QString &directory = QString());
+
+    // Bulk version of extractPalette(). Every entry is checked before any
+    // file is written; palettes are then decoded and PNG-encoded on the
+    // thread pool one batch ahead of the calling thread, which only writes
+    // files, so disk I/O overlaps the encoding.
+    bool extractPalettes(const QList<PaletteSettings> &paletteList, const QString &directory, int &extractedCount);
+
+    // Consecutive palettes of first.colorCount colors from first.address up
+    // to, not including, endAddress. Both are read like settings.address;
+    // the walk goes through file offsets so unmapped bus gaps are skipped.
+    bool paletteRange(const PaletteSettings &first, quint32 endAddress, QList<PaletteSettings> &paletteList);
+
+    QString extractFileName(const PaletteSettings &settings, const QString &suffix) const;
+    QString quickExtractPath(const PaletteSettings &settings, const QString &suffix) const;
+
+    QString errorString() const;
+
+private:
+    RomStorage rom;
+    AddressMapper mapper;
+    ByteRangeSet dirtyRanges;
+    ByteRange pendingEdit;
+    QByteArray pendingOriginal;
+    EditJournal journal;
+    ByteRangeSet patchRanges;
+    PaletteIndex searchIndex;
+    mutable SnesChecksum romChecksum;
+    QStringList pendingPatchPaths;
+    int appliedPatchCount;
+    qsizetype sourceSize;
+    qsizetype sourceHeaderSize;
+    mutable quint32 sourceCrc;
+    mutable quint32 headerlessCrc;
+    mutable QCryptographicHash sourceSha1;
+    mutable QCryptographicHash headerlessSha1;
+    mutable qsizetype hashedSize;
+    mutable RomFingerprint sourceFingerprint;
+    mutable bool sourceHashed;
+    ColorQuantization quantization;
+    bool updateChecksumOnSave;
+    bool editGroupOpen;
+    bool editGroupRecorded;
+    QString lastError;
+
+    bool checkRange(const PaletteSettings &settings, quint32 &fileOffset);
+    bool prepareManifestJob(const ManifestEntry &entry, ManifestJob &job);
+    bool saveTo(const QString &filePath);
+    void prepareHeaderChecksum(RomSaveJob &job) const;
+    void resetSourceHash() const;
+    void hashSourceChunk(QByteArrayView chunk) const;
+    void finishSourceHash() const;
+    void hashSourceFile() const;
+    void sumChecksum() const;
+
+    // Every write into the ROM goes through beginEdit()/endEdit() so the
+    // modified ranges and the edit journal stay accurate.
+    uchar *beginEdit(quint32 offset, quint32 length);
+    void endEdit();
+    void beginEditGroup();
+    void endEditGroup();
+    void applyDelta(quint32 offset, const QByteArray &bytes, ByteRange &changedRange);
+    void setError(const QString &message);
+};
+
+#endif // PALETTEENGINE_H
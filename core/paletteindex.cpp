@@ -0,0 +1,221 @@
+#include "paletteindex.h"
+#include "snescolor.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+
+#include <cstring>
+
+static const quint32 subPaletteColors = 16;
+
+
+
+static inline quint32 windowHash(const uchar *data, int bits)
+{
+    quint64 window;
+    memcpy(&window, data, sizeof(window));
+    return quint32((window * Q_UINT64_C(0x9E3779B97F4A7C15)) >> (64 - bits));
+}
+
+
+
+PaletteIndex::PaletteIndex()
+    : bucketBits(0)
+{
+}
+
+
+
+void PaletteIndex::build(QByteArrayView romData)
+{
+    clear();
+
+    const qsizetype windowCount = romData.size() - keyBytes + 1;
+
+    if (windowCount <= 0 || romData.size() > qsizetype(0xFFFFFFFF))
+    {
+        return;
+    }
+
+    // About four windows per bucket.
+    bucketBits = 10;
+
+    while (bucketBits < 24 && (qsizetype(1) << (bucketBits + 2)) < windowCount)
+    {
+        bucketBits++;
+    }
+
+    const uchar *data = reinterpret_cast<const uchar *>(romData.data());
+    bucketStarts.fill(0, (qsizetype(1) << bucketBits) + 1);
+
+    for (qsizetype offset = 0; offset < windowCount; offset++)
+    {
+        bucketStarts[windowHash(data + offset, bucketBits) + 1]++;
+    }
+
+    for (qsizetype bucket = 1; bucket < bucketStarts.size(); bucket++)
+    {
+        bucketStarts[bucket] += bucketStarts.at(bucket - 1);
+    }
+
+    QList<quint32> next = bucketStarts;
+    offsets.resize(windowCount);
+
+    for (qsizetype offset = 0; offset < windowCount; offset++)
+    {
+        offsets[next[windowHash(data + offset, bucketBits)]++] = quint32(offset);
+    }
+}
+
+
+
+void PaletteIndex::clear()
+{
+    bucketBits = 0;
+    bucketStarts.clear();
+    offsets.clear();
+}
+
+bool PaletteIndex::isEmpty() const
+{
+    return offsets.isEmpty();
+}
+
+
+
+QList<quint32> PaletteIndex::find(QByteArrayView romData, QByteArrayView colors) const
+{
+    QList<quint32> found;
+
+    if (colors.isEmpty() || colors.size() > romData.size())
+    {
+        return found;
+    }
+
+    if (colors.size() < keyBytes || isEmpty())
+    {
+        for (qsizetype offset = romData.indexOf(colors); offset >= 0; offset = romData.indexOf(colors, offset + 1))
+        {
+            found.append(quint32(offset));
+        }
+
+        return found;
+    }
+
+    const uchar *data = reinterpret_cast<const uchar *>(romData.data());
+    const quint32 bucket = windowHash(reinterpret_cast<const uchar *>(colors.data()), bucketBits);
+
+    for (quint32 i = bucketStarts.at(bucket); i < bucketStarts.at(bucket + 1); i++)
+    {
+        const quint32 offset = offsets.at(i);
+
+        if (offset + colors.size() <= quint64(romData.size()) && memcmp(data + offset, colors.data(), colors.size()) == 0)
+        {
+            found.append(offset);
+        }
+    }
+
+    // Buckets are filled in offset order, so the matches already are too.
+    return found;
+}
+
+
+
+QList<PaletteMatch> PaletteIndex::find(QByteArrayView romData, const QList<PaletteQuery> &queries) const
+{
+    QList<PaletteMatch> matches;
+
+    for (int query = 0; query < queries.size(); query++)
+    {
+        for (quint32 address : find(romData, queries.at(query).colors))
+        {
+            matches.append({ query, address });
+        }
+    }
+
+    return matches;
+}
+
+
+
+QList<PaletteQuery> PaletteIndex::loadQueries(const QString &path, QString &errorString)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    QByteArray colors;
+
+    if (suffix == "png" || suffix == "bmp")
+    {
+        QImage image(path);
+
+        if (image.isNull())
+        {
+            errorString = "Failed to open image file.";
+            return QList<PaletteQuery>();
+        }
+
+        image.convertTo(QImage::Format_RGB32);
+        colors.resize(qsizetype(image.width()) * image.height() * 2);
+
+        for (int y = 0; y < image.height(); y++)
+        {
+            rgbToSNESBulk(reinterpret_cast<const QRgb *>(image.constScanLine(y)),
+                          reinterpret_cast<uchar *>(colors.data()) + qsizetype(y) * image.width() * 2,
+                          image.width());
+        }
+    }
+    else
+    {
+        QFile file(path);
+
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            errorString = "Failed to open palette file.";
+            return QList<PaletteQuery>();
+        }
+
+        QByteArray fileData = file.readAll();
+
+        if (suffix == "pal")
+        {
+            qsizetype count = fileData.size() / 3;
+            colors.resize(count * 2);
+            rgb888ToSNESBulk(reinterpret_cast<const uchar *>(fileData.constData()), reinterpret_cast<uchar *>(colors.data()), count);
+        }
+        else
+        {
+            colors = fileData.left(fileData.size() & ~1);
+        }
+    }
+
+    const quint32 colorCount = colors.size() / 2;
+    const quint32 queryColors = (colorCount > subPaletteColors && colorCount % subPaletteColors == 0) ? subPaletteColors : colorCount;
+    const QString baseName = QFileInfo(path).fileName();
+    QList<PaletteQuery> queries;
+
+    for (quint32 first = 0; queryColors > 0 && first < colorCount; first += queryColors)
+    {
+        PaletteQuery query;
+        query.colors = colors.mid(first * 2, queryColors * 2);
+        query.name = queryColors == colorCount ? baseName : QString("%1 #%2").arg(baseName).arg(first / queryColors);
+
+        bool uniform = true;
+
+        for (qsizetype i = 2; i < query.colors.size() && uniform; i += 2)
+        {
+            uniform = memcmp(query.colors.constData() + i, query.colors.constData(), 2) == 0;
+        }
+
+        if (!uniform)
+        {
+            queries.append(query);
+        }
+    }
+
+    if (queries.isEmpty())
+    {
+        errorString = "No usable colors in palette file.";
+    }
+
+    return queries;
+}
@@ -0,0 +1,59 @@
+#ifndef PALETTEINDEX_H
+#define PALETTEINDEX_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QString>
+
+// A palette to look for: BGR555 colors as little endian words.
+struct PaletteQuery
+{
+    QString name;
+    QByteArray colors;
+};
+
+struct PaletteMatch
+{
+    int query = 0;
+    quint32 address = 0;
+};
+
+// Hash index over every 8 byte window (4 colors) of a ROM, at both byte
+// alignments, for exact palette lookups.
+//
+// Offsets are bucketed by the hash of their window with a counting sort, so
+// the index is two flat arrays built in two linear passes. A lookup hashes
+// the first four colors of the query and only compares the offsets in that
+// bucket, which makes hundreds of queries against a multi-megabyte ROM a
+// matter of milliseconds. Queries shorter than four colors fall back to a
+// linear search. The index holds no ROM data; pass the same bytes it was
+// built from (matches are always verified against them).
+class PaletteIndex
+{
+public:
+    static const int keyBytes = 8;
+
+    PaletteIndex();
+
+    void build(QByteArrayView romData);
+    void clear();
+    bool isEmpty() const;
+
+    QList<quint32> find(QByteArrayView romData, QByteArrayView colors) const;
+    QList<PaletteMatch> find(QByteArrayView romData, const QList<PaletteQuery> &queries) const;
+
+    // Reads the colors of a CGRAM dump or raw .bin (little endian words),
+    // a .pal (RGB triplets) or a palette image (pixels in row order). More
+    // than 16 colors in a multiple of 16 are split into 16 color
+    // sub-palettes, like CGRAM. Queries of a single repeated color are
+    // dropped since they match almost everywhere.
+    static QList<PaletteQuery> loadQueries(const QString &path, QString &errorString);
+
+private:
+    int bucketBits;
+    QList<quint32> bucketStarts;
+    QList<quint32> offsets;
+};
+
+#endif // PALETTEINDEX_H
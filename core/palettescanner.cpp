@@ -0,0 +1,393 @@
+#include "palettescanner.h"
+#include "byterangeset.h"
+#include "colorquantizer.h"
+
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <algorithm>
+
+static const qsizetype scanChunkSize = 64 * 1024;
+static const quint32 subPaletteSize = 16;
+
+
+
+float PaletteScanner::scoreBlock(const uchar *blockData, quint32 colorCount, quint32 address)
+{
+    if (colorCount < 2 || colorCount > 256)
+    {
+        return 0.0f;
+    }
+
+    quint16 colors[256];
+    int luma[256];
+
+    for (quint32 i = 0; i < colorCount; i++)
+    {
+        quint16 snesColor = qFromLittleEndian<quint16>(blockData + i * 2);
+
+        // Real CGRAM data never sets bit 15.
+        if (snesColor & 0x8000)
+        {
+            return 0.0f;
+        }
+
+        colors[i] = snesColor;
+
+        int r = snesColor & 0x1F;
+        int g = (snesColor >> 5) & 0x1F;
+        int b = (snesColor >> 10) & 0x1F;
+        luma[i] = r * 77 + g * 150 + b * 29;
+    }
+
+    int distinct = 0;
+    quint16 seen[256];
+
+    for (quint32 i = 0; i < colorCount && distinct < 4; i++)
+    {
+        if (std::find(seen, seen + distinct, colors[i]) == seen + distinct)
+        {
+            seen[distinct++] = colors[i];
+        }
+    }
+
+    if (distinct < qMin<quint32>(4, colorCount))
+    {
+        return 0.0f;
+    }
+
+    int pairs = 0;
+    int smoothPairs = 0;
+    int directionChanges = 0;
+    int color0Hits = 0;
+    int subPalettes = 0;
+
+    for (quint32 first = 0; first < colorCount; first += subPaletteSize)
+    {
+        quint32 last = qMin(first + subPaletteSize, colorCount);
+        int previousDelta = 0;
+        subPalettes++;
+
+        if (colors[first] == 0x0000)
+        {
+            color0Hits++;
+        }
+
+        // Color 0 is usually transparent, so ramps are judged from color 1.
+        for (quint32 i = first + 2; i < last; i++)
+        {
+            int delta = luma[i] - luma[i - 1];
+            pairs++;
+
+            if (qAbs(delta) <= 8 * 256)
+            {
+                smoothPairs++;
+            }
+
+            if ((delta > 0 && previousDelta < 0) || (delta < 0 && previousDelta > 0))
+            {
+                directionChanges++;
+            }
+
+            if (delta != 0)
+            {
+                previousDelta = delta;
+            }
+        }
+    }
+
+    if (pairs == 0)
+    {
+        return 0.0f;
+    }
+
+    float smooth = float(smoothPairs) / pairs;
+    float monotonic = 1.0f - qMin(1.0f, float(directionChanges) / qMax(1, pairs - subPalettes));
+    float score = smooth * 0.45f + monotonic * 0.35f;
+
+    score += 0.1f * color0Hits / subPalettes;
+
+    if (address % 32 == 0)
+    {
+        score += 0.1f;
+    }
+    else if (address % 16 == 0)
+    {
+        score += 0.05f;
+    }
+
+    return score;
+}
+
+
+
+QList<PaletteCandidate> PaletteScanner::selectBest(QList<PaletteCandidate> candidates, quint32 blockBytes, int maxResults)
+{
+    std::sort(candidates.begin(), candidates.end(), [](const PaletteCandidate &a, const PaletteCandidate &b) {
+        return a.score > b.score || (a.score == b.score && a.address < b.address);
+    });
+
+    QList<PaletteCandidate> selected;
+    ByteRangeSet taken;
+
+    for (const PaletteCandidate &candidate : std::as_const(candidates))
+    {
+        if (selected.size() >= maxResults)
+        {
+            break;
+        }
+
+        if (!taken.intersects(candidate.address, blockBytes))
+        {
+            taken.add(candidate.address, blockBytes);
+            selected.append(candidate);
+        }
+    }
+
+    return selected;
+}
+
+
+
+QList<PaletteCandidate> PaletteScanner::scan(QByteArrayView romData, const PaletteScanOptions &options)
+{
+    const quint32 blockBytes = options.colorCount * 2;
+    const quint32 alignment = qMax<quint32>(options.alignment, 1);
+
+    if (options.colorCount < 2 || romData.size() < qsizetype(blockBytes))
+    {
+        return QList<PaletteCandidate>();
+    }
+
+    const uchar *data = reinterpret_cast<const uchar *>(romData.data());
+    const qsizetype lastStart = romData.size() - blockBytes;
+
+    QList<qsizetype> chunkStarts;
+
+    for (qsizetype start = 0; start <= lastStart; start += scanChunkSize)
+    {
+        chunkStarts.append(start);
+    }
+
+    auto scanChunk = [&](qsizetype chunkStart) {
+        QList<PaletteCandidate> found;
+        qsizetype chunkEnd = qMin(chunkStart + scanChunkSize - 1, lastStart);
+        qsizetype offset = (chunkStart + alignment - 1) / alignment * alignment;
+
+        for (; offset <= chunkEnd; offset += alignment)
+        {
+            float score = scoreBlock(data + offset, options.colorCount, offset);
+
+            if (score >= options.minimumScore)
+            {
+                PaletteCandidate candidate;
+                candidate.address = offset;
+                candidate.score = score;
+                candidate.colorCount = options.colorCount;
+                found.append(candidate);
+            }
+        }
+
+        return selectBest(found, blockBytes, options.maxResults);
+    };
+
+    auto merge = [](QList<PaletteCandidate> &all, const QList<PaletteCandidate> &found) {
+        all.append(found);
+    };
+
+    QList<PaletteCandidate> all = QtConcurrent::blockingMappedReduced<QList<PaletteCandidate>>(chunkStarts, scanChunk, merge);
+
+    return selectBest(all, blockBytes, options.maxResults);
+}
+
+
+
+// Unique colors of an image reduced to BGR555 by rounding, which undoes
+// the usual 5 -> 8 bit expansion of emulator output.
+QList<quint16> PaletteScanner::referenceColors(const QImage &image, quint32 minimumPixelCount)
+{
+    const QImage rgbImage = image.convertToFormat(QImage::Format_RGB32);
+    QList<quint32> pixelCounts(32768, 0);
+    QList<uchar> snesLine(rgbImage.width() * 2);
+
+    for (int y = 0; y < rgbImage.height(); y++)
+    {
+        quantizeToSNES(reinterpret_cast<const QRgb *>(rgbImage.constScanLine(y)), snesLine.data(), rgbImage.width(), ColorQuantization::Round);
+
+        for (int x = 0; x < rgbImage.width(); x++)
+        {
+            pixelCounts[snesLine.at(x * 2) | ((snesLine.at(x * 2 + 1) & 0x7F) << 8)]++;
+        }
+    }
+
+    QList<quint16> colors;
+
+    for (quint32 color = 0; color < 32768; color++)
+    {
+        if (pixelCounts.at(color) >= qMax<quint32>(minimumPixelCount, 1))
+        {
+            colors.append(color);
+        }
+    }
+
+    return colors;
+}
+
+
+
+// Weight of every possible ROM word: 256 for a reference color, falling off
+// linearly to 0 at tolerance + 1 summed channel steps away, and 0 for words
+// with bit 15 set. The L1 distance to the nearest reference color is an
+// exact separable distance transform, one forward and backward pass per
+// channel.
+static QList<quint16> fuzzyWeights(const QList<quint16> &referenceColors, int tolerance)
+{
+    QList<quint8> distance(32768, 255);
+
+    for (quint16 color : referenceColors)
+    {
+        distance[color & 0x7FFF] = 0;
+    }
+
+    for (int channel = 0; channel < 3; channel++)
+    {
+        const int stride = 1 << (channel * 5);
+
+        for (int color = 0; color < 32768; color++)
+        {
+            const int level = (color / stride) & 0x1F;
+
+            if (level > 0)
+            {
+                distance[color] = qMin<int>(distance.at(color), distance.at(color - stride) + 1);
+            }
+        }
+
+        for (int color = 32767; color >= 0; color--)
+        {
+            const int level = (color / stride) & 0x1F;
+
+            if (level < 31)
+            {
+                distance[color] = qMin<int>(distance.at(color), distance.at(color + stride) + 1);
+            }
+        }
+    }
+
+    QList<quint16> weights(65536, 0);
+
+    for (int color = 0; color < 32768; color++)
+    {
+        weights[color] = quint16(qMax(0, tolerance + 1 - distance.at(color)) * 256 / (tolerance + 1));
+    }
+
+    return weights;
+}
+
+
+
+QList<PaletteCandidate> PaletteScanner::findSimilar(QByteArrayView romData, const QList<quint16> &referenceColors, const FuzzySearchOptions &options)
+{
+    const quint32 colorCount = options.colorCount;
+    const quint32 blockBytes = colorCount * 2;
+    const quint32 alignment = qMax<quint32>(options.alignment, 1);
+    const quint32 skipped = options.ignoreColorZero ? 1 : 0;
+
+    if (colorCount < 2 || referenceColors.isEmpty() || romData.size() < qsizetype(blockBytes))
+    {
+        return QList<PaletteCandidate>();
+    }
+
+    const QList<quint16> weights = fuzzyWeights(referenceColors, qMax(0, options.tolerance));
+    const quint32 threshold = quint32(options.minimumScore * 256 * (colorCount - skipped));
+    const quint32 minimumDistinct = qMin<quint32>(4, colorCount / 2);
+    const uchar *data = reinterpret_cast<const uchar *>(romData.data());
+    const qsizetype lastStart = romData.size() - blockBytes;
+
+    QList<qsizetype> chunkStarts;
+
+    for (qsizetype start = 0; start <= lastStart; start += scanChunkSize)
+    {
+        chunkStarts.append(start);
+    }
+
+    auto searchChunk = [&](qsizetype chunkStart) {
+        QList<PaletteCandidate> found;
+        const qsizetype chunkEnd = qMin(chunkStart + scanChunkSize, lastStart + 1);
+        QList<quint32> prefix;
+
+        // Words of each byte parity get their own prefix sums, so the
+        // weight of any window is one subtraction.
+        for (int parity = 0; parity < 2; parity++)
+        {
+            const qsizetype wordBase = chunkStart + ((chunkStart & 1) != parity ? 1 : 0);
+
+            if (wordBase >= chunkEnd)
+            {
+                continue;
+            }
+
+            const qsizetype windowCount = (chunkEnd - wordBase + 1) / 2;
+            const qsizetype wordCount = windowCount + colorCount - 1;
+            prefix.resize(wordCount + 1);
+            prefix[0] = 0;
+
+            for (qsizetype j = 0; j < wordCount; j++)
+            {
+                prefix[j + 1] = prefix.at(j) + weights.at(qFromLittleEndian<quint16>(data + wordBase + j * 2));
+            }
+
+            for (qsizetype j = 0; j < windowCount; j++)
+            {
+                const qsizetype offset = wordBase + j * 2;
+
+                if (offset % alignment != 0)
+                {
+                    continue;
+                }
+
+                const quint32 sum = prefix.at(j + colorCount) - prefix.at(j + skipped);
+
+                if (sum < threshold)
+                {
+                    continue;
+                }
+
+                // A window of one or two repeated colors matches any
+                // reference that has them.
+                QList<quint16> distinct;
+
+                for (quint32 i = skipped; i < colorCount && quint32(distinct.size()) < minimumDistinct; i++)
+                {
+                    const quint16 word = qFromLittleEndian<quint16>(data + offset + i * 2);
+
+                    if (!distinct.contains(word))
+                    {
+                        distinct.append(word);
+                    }
+                }
+
+                if (quint32(distinct.size()) < minimumDistinct)
+                {
+                    continue;
+                }
+
+                PaletteCandidate candidate;
+                candidate.address = offset;
+                candidate.score = float(sum) / (256 * (colorCount - skipped));
+                candidate.colorCount = colorCount;
+                found.append(candidate);
+            }
+        }
+
+        return selectBest(found, blockBytes, options.maxResults);
+    };
+
+    auto merge = [](QList<PaletteCandidate> &all, const QList<PaletteCandidate> &found) {
+        all.append(found);
+    };
+
+    QList<PaletteCandidate> all = QtConcurrent::blockingMappedReduced<QList<PaletteCandidate>>(chunkStarts, searchChunk, merge);
+
+    return selectBest(all, blockBytes, options.maxResults);
+}
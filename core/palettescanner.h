@@ -0,0 +1,70 @@
+#ifndef PALETTESCANNER_H
+#define PALETTESCANNER_H
+
+#include <QByteArrayView>
+#include <QImage>
+#include <QList>
+
+struct PaletteCandidate
+{
+    quint32 address = 0;
+    float score = 0.0f;
+    quint32 colorCount = 16;
+};
+
+struct PaletteScanOptions
+{
+    quint32 colorCount = 16;
+    quint32 alignment = 2;
+    int maxResults = 256;
+    float minimumScore = 0.55f;
+};
+
+struct FuzzySearchOptions
+{
+    quint32 colorCount = 16;
+    quint32 alignment = 2;
+    int maxResults = 32;
+    float minimumScore = 0.75f;
+
+    // Summed per-channel BGR555 distance at which a color stops counting
+    // as present in the reference.
+    int tolerance = 3;
+
+    // Color 0 is usually transparent and never shows up on screen.
+    bool ignoreColorZero = true;
+
+    // Reference colors seen on fewer pixels are treated as filter blends.
+    quint32 minimumPixelCount = 4;
+};
+
+// Walks a whole ROM looking for data that looks like BGR555 palettes.
+//
+// Every aligned window of colorCount words is scored on a few cheap
+// heuristics: bit 15 must be clear in every word, the block must hold
+// several distinct colors, neighbouring colors should form smooth luminance
+// ramps, color 0 is often black/transparent, and palettes tend to sit on
+// 16/32 byte boundaries. The ROM is split into chunks that are scored on
+// all cores; overlapping hits are reduced to the best scoring one.
+//
+// findSimilar() instead looks for palettes whose colors appear, within a
+// tolerance, in a reference set such as the unique colors of a screenshot.
+// A distance transform over the whole BGR555 cube turns the reference into
+// a per-color weight table, so a window's score is a sum of table lookups,
+// kept as prefix sums so every window costs O(1). Only windows over the
+// score threshold are checked further.
+class PaletteScanner
+{
+public:
+    static QList<PaletteCandidate> scan(QByteArrayView romData, const PaletteScanOptions &options = PaletteScanOptions());
+    static float scoreBlock(const uchar *blockData, quint32 colorCount, quint32 address);
+
+    static QList<quint16> referenceColors(const QImage &image, quint32 minimumPixelCount);
+    static QList<PaletteCandidate> findSimilar(QByteArrayView romData, const QList<quint16> &referenceColors,
+                                               const FuzzySearchOptions &options = FuzzySearchOptions());
+
+private:
+    static QList<PaletteCandidate> selectBest(QList<PaletteCandidate> candidates, quint32 blockBytes, int maxResults);
+};
+
+#endif // PALETTESCANNER_H
@@ -0,0 +1,158 @@
+#include "romcache.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+static const quint32 cacheMagic = 0x53504957; // "SPIW"
+static const quint16 cacheVersion = 1;
+
+
+
+RomCache::RomCache(const QString &directory)
+    : cacheDirectory(directory)
+{
+}
+
+
+
+QString RomCache::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/SNES Palette Imager/roms";
+}
+
+
+
+QString RomCache::entryPath(const RomFingerprint &fingerprint) const
+{
+    return QDir(cacheDirectory).filePath(QString::fromLatin1(fingerprint.headerlessSha1.toHex()) + ".workspace");
+}
+
+
+
+// Bus addresses do not depend on the copier header; file offsets do.
+static quint32 shiftOffset(quint32 address, bool busAddress, qint64 shift)
+{
+    if (busAddress || qint64(address) + shift < 0)
+    {
+        return address;
+    }
+
+    return quint32(qint64(address) + shift);
+}
+
+
+
+bool RomCache::load(const RomFingerprint &fingerprint, RomWorkspace &workspace) const
+{
+    if (!fingerprint.isValid())
+    {
+        return false;
+    }
+
+    QFile file(entryPath(fingerprint));
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic;
+    quint16 version;
+    quint32 crc;
+    qint32 mapMode;
+    quint32 paletteCount;
+    RomWorkspace loaded;
+
+    stream >> magic >> version >> crc;
+
+    // The CRC guards against a (practically impossible) SHA-1 file name
+    // clash and against entries copied over from elsewhere.
+    if (magic != cacheMagic || version != cacheVersion || crc != fingerprint.headerlessCrc32)
+    {
+        return false;
+    }
+
+    stream >> mapMode >> loaded.lastPalette.address >> loaded.lastPalette.colorCount
+           >> loaded.lastPalette.rowWidth >> loaded.lastPalette.busAddress >> paletteCount;
+
+    if (stream.status() != QDataStream::Ok || mapMode < 0 || mapMode > qint32(AddressMapMode::Sdd1Rom))
+    {
+        return false;
+    }
+
+    const qint64 shift = fingerprint.copierHeader;
+    loaded.mapMode = AddressMapMode(mapMode);
+    loaded.lastPalette.address = shiftOffset(loaded.lastPalette.address, loaded.lastPalette.busAddress, shift);
+
+    for (quint32 i = 0; i < paletteCount && stream.status() == QDataStream::Ok; i++)
+    {
+        PaletteCandidate candidate;
+        stream >> candidate.address >> candidate.score >> candidate.colorCount;
+        candidate.address = shiftOffset(candidate.address, false, shift);
+        loaded.palettes.append(candidate);
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        return false;
+    }
+
+    workspace = loaded;
+    return true;
+}
+
+
+
+bool RomCache::save(const RomFingerprint &fingerprint, const RomWorkspace &workspace, QString &errorString) const
+{
+    if (!fingerprint.isValid())
+    {
+        errorString = "ROM has no fingerprint.";
+        return false;
+    }
+
+    if (!QDir().mkpath(cacheDirectory))
+    {
+        errorString = "Failed to create ROM cache folder.";
+        return false;
+    }
+
+    QSaveFile file(entryPath(fingerprint));
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        errorString = "Failed to open ROM cache entry for writing.";
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    const qint64 shift = -qint64(fingerprint.copierHeader);
+    const PaletteSettings &lastPalette = workspace.lastPalette;
+
+    stream << cacheMagic << cacheVersion << fingerprint.headerlessCrc32
+           << qint32(workspace.mapMode)
+           << shiftOffset(lastPalette.address, lastPalette.busAddress, shift) << lastPalette.colorCount
+           << lastPalette.rowWidth << lastPalette.busAddress
+           << quint32(workspace.palettes.size());
+
+    for (const PaletteCandidate &candidate : workspace.palettes)
+    {
+        stream << shiftOffset(candidate.address, false, shift) << candidate.score << candidate.colorCount;
+    }
+
+    if (!file.commit())
+    {
+        errorString = "Failed to write ROM cache entry.";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,41 @@
+#ifndef ROMCACHE_H
+#define ROMCACHE_H
+
+#include <QList>
+#include <QString>
+
+#include "addressmapper.h"
+#include "paletteengine.h"
+#include "palettescanner.h"
+
+// What is remembered about a ROM between sessions.
+struct RomWorkspace
+{
+    AddressMapMode mapMode = AddressMapMode::None;
+    PaletteSettings lastPalette;
+    QList<PaletteCandidate> palettes;
+};
+
+// Local cache of per-ROM workspaces, one small binary file per ROM named
+// after its headerless SHA-1, so reopening a known ROM restores its map
+// mode, last palette and found palettes without rescanning. File offsets
+// are stored without the copier header and shifted back on load, which
+// lets headered and unheadered dumps share one entry.
+class RomCache
+{
+public:
+    explicit RomCache(const QString &directory = defaultDirectory());
+
+    // A folder shared by the GUI and spi under the user's data location.
+    static QString defaultDirectory();
+
+    bool load(const RomFingerprint &fingerprint, RomWorkspace &workspace) const;
+    bool save(const RomFingerprint &fingerprint, const RomWorkspace &workspace, QString &errorString) const;
+
+private:
+    QString cacheDirectory;
+
+    QString entryPath(const RomFingerprint &fingerprint) const;
+};
+
+#endif // ROMCACHE_H
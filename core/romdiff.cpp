@@ -0,0 +1,267 @@
+#include "romdiff.h"
+#include "romdiff_p.h"
+#include "cpufeatures.h"
+#include "paletteengine.h"
+#include "palettescanner.h"
+
+#include <QPainter>
+#include <QTextStream>
+#include <QtEndian>
+
+#include <cstring>
+
+static const quint32 blockBytes = 32;
+static const quint32 maxRenderColors = 4096;
+static const qsizetype maxReportBytes = 512;
+
+
+
+qsizetype findMismatch_scalar(const uchar *a, const uchar *b, qsizetype length)
+{
+    qsizetype i = 0;
+
+    for (; i + 8 <= length; i += 8)
+    {
+        quint64 wordA;
+        quint64 wordB;
+        memcpy(&wordA, a + i, 8);
+        memcpy(&wordB, b + i, 8);
+
+        if (wordA != wordB)
+        {
+            break;
+        }
+    }
+
+    while (i < length && a[i] == b[i])
+    {
+        i++;
+    }
+
+    return i;
+}
+
+
+
+qsizetype RomDiff::mismatch(const uchar *a, const uchar *b, qsizetype length)
+{
+#if defined(SPI_X86_SIMD)
+    if (cpuHasAVX2())
+    {
+        return findMismatch_avx2(a, b, length);
+    }
+
+    return findMismatch_sse2(a, b, length);
+#else
+    return findMismatch_scalar(a, b, length);
+#endif
+}
+
+
+
+static bool blocksLookLikePalette(QByteArrayView data, quint32 first, quint32 last, float minimumScore)
+{
+    quint32 blocks = 0;
+    quint32 paletteBlocks = 0;
+
+    for (quint32 block = first; block < last && block + blockBytes <= data.size(); block += blockBytes)
+    {
+        blocks++;
+
+        if (PaletteScanner::scoreBlock(reinterpret_cast<const uchar *>(data.data()) + block, blockBytes / 2, block) >= minimumScore)
+        {
+            paletteBlocks++;
+        }
+    }
+
+    return blocks > 0 && paletteBlocks * 2 >= blocks;
+}
+
+
+
+QList<RomDiffRange> RomDiff::compare(QByteArrayView before, QByteArrayView after, const RomDiffOptions &options)
+{
+    QList<RomDiffRange> ranges;
+    const uchar *a = reinterpret_cast<const uchar *>(before.data());
+    const uchar *b = reinterpret_cast<const uchar *>(after.data());
+    const qsizetype common = qMin(before.size(), after.size());
+    qsizetype position = 0;
+
+    while (position < common)
+    {
+        position += mismatch(a + position, b + position, common - position);
+
+        if (position >= common)
+        {
+            break;
+        }
+
+        // Differences are short in practice, so the end of a range is found
+        // byte by byte: it closes after mergeGap equal bytes in a row.
+        const qsizetype start = position;
+        qsizetype lastDifference = position;
+
+        while (position < common && position - lastDifference <= options.mergeGap)
+        {
+            if (a[position] != b[position])
+            {
+                lastDifference = position;
+            }
+
+            position++;
+        }
+
+        RomDiffRange range;
+        range.offset = quint32(start & ~qsizetype(1));
+        range.length = quint32(qMin<qsizetype>((lastDifference + 2) & ~qsizetype(1), common) - range.offset);
+
+        const quint32 first = range.offset & ~(blockBytes - 1);
+        const quint32 last = range.offset + range.length;
+        range.paletteLike = blocksLookLikePalette(after, first, last, options.minimumPaletteScore)
+                            || blocksLookLikePalette(before, first, last, options.minimumPaletteScore);
+
+        // Word alignment can make neighbouring ranges touch.
+        if (!ranges.isEmpty() && ranges.last().offset + ranges.last().length >= range.offset)
+        {
+            RomDiffRange &previous = ranges.last();
+            previous.length = range.offset + range.length - previous.offset;
+            previous.paletteLike = previous.paletteLike && range.paletteLike;
+            continue;
+        }
+
+        ranges.append(range);
+    }
+
+    if (before.size() != after.size())
+    {
+        RomDiffRange tail;
+        tail.offset = quint32(common);
+        tail.length = quint32(qMax(before.size(), after.size()) - common);
+        ranges.append(tail);
+    }
+
+    return ranges;
+}
+
+
+
+QImage RomDiff::renderRange(QByteArrayView before, QByteArrayView after, const RomDiffRange &range, quint32 rowWidth)
+{
+    quint32 first = range.offset & ~1u;
+    quint32 last = (range.offset + range.length + 1) & ~1u;
+
+    if (range.paletteLike)
+    {
+        first &= ~(blockBytes - 1);
+        last = (last + blockBytes - 1) & ~(blockBytes - 1);
+    }
+
+    PaletteSettings settings;
+    settings.address = first;
+    settings.colorCount = qMin((last - first) / 2, maxRenderColors);
+    settings.rowWidth = qMax<quint32>(rowWidth, 1);
+
+    QImage beforeImage;
+    QImage afterImage;
+
+    if (first < before.size())
+    {
+        beforeImage = PaletteEngine::getImageFromBin(before.sliced(first), settings);
+    }
+
+    if (first < after.size())
+    {
+        afterImage = PaletteEngine::getImageFromBin(after.sliced(first), settings);
+    }
+
+    // One column of the background separates the two strips.
+    const int gap = 1;
+    QImage sideBySide(beforeImage.width() + gap + afterImage.width(),
+                      qMax(beforeImage.height(), afterImage.height()), QImage::Format_RGB32);
+
+    if (sideBySide.isNull())
+    {
+        return sideBySide;
+    }
+
+    sideBySide.fill(qRgb(64, 64, 64));
+
+    QPainter painter(&sideBySide);
+    painter.drawImage(0, 0, beforeImage);
+    painter.drawImage(beforeImage.width() + gap, 0, afterImage);
+    painter.end();
+
+    return sideBySide;
+}
+
+
+
+static QString hexBytes(QByteArrayView data, quint32 offset, quint32 length, bool words)
+{
+    if (offset >= data.size())
+    {
+        return QString();
+    }
+
+    const qsizetype count = qMin<qsizetype>(qMin<qsizetype>(length, data.size() - offset), maxReportBytes);
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.data()) + offset;
+    QStringList parts;
+
+    if (words)
+    {
+        for (qsizetype i = 0; i + 1 < count; i += 2)
+        {
+            parts.append(QString::number(qFromLittleEndian<quint16>(bytes + i), 16).rightJustified(4, '0').toUpper());
+        }
+    }
+    else
+    {
+        parts.append(QString::fromLatin1(QByteArray(reinterpret_cast<const char *>(bytes), count).toHex().toUpper()));
+    }
+
+    QString text = parts.join(' ');
+
+    if (count < qsizetype(length) && offset + count < data.size())
+    {
+        text += "...";
+    }
+
+    return text;
+}
+
+
+
+bool RomDiff::writeReport(QIODevice *device, QByteArrayView before, QByteArrayView after,
+                          const QList<RomDiffRange> &ranges, const AddressMapper &mapper, QString &errorString)
+{
+    QTextStream stream(device);
+    stream << "offset,bus address,length,palette,before,after\n";
+
+    for (const RomDiffRange &range : ranges)
+    {
+        quint32 busAddress;
+        QString busText;
+
+        if (mapper.mode() != AddressMapMode::None && mapper.fileToBus(range.offset, busAddress))
+        {
+            busText = "$" + QString::number(busAddress, 16).rightJustified(6, '0').toUpper();
+        }
+
+        stream << "0x" << QString::number(range.offset, 16).rightJustified(6, '0').toUpper() << ','
+               << busText << ','
+               << range.length << ','
+               << (range.paletteLike ? "yes" : "no") << ','
+               << hexBytes(before, range.offset, range.length, range.paletteLike) << ','
+               << hexBytes(after, range.offset, range.length, range.paletteLike) << '\n';
+    }
+
+    stream.flush();
+
+    if (stream.status() != QTextStream::Ok)
+    {
+        errorString = "Failed to write the diff report.";
+        return false;
+    }
+
+    return true;
+}
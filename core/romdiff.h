@@ -0,0 +1,59 @@
+#ifndef ROMDIFF_H
+#define ROMDIFF_H
+
+#include <QByteArrayView>
+#include <QIODevice>
+#include <QImage>
+#include <QList>
+#include <QString>
+
+#include "addressmapper.h"
+
+struct RomDiffRange
+{
+    quint32 offset = 0;
+    quint32 length = 0;
+    bool paletteLike = false;
+};
+
+struct RomDiffOptions
+{
+    // Differences separated by at most this many equal bytes form one range.
+    quint32 mergeGap = 32;
+
+    // A range is palette-like when at least half of the 16 color blocks
+    // around it score this high (see PaletteScanner::scoreBlock) in either
+    // ROM.
+    float minimumPaletteScore = 0.5f;
+};
+
+// Byte-level comparison of two ROM images, e.g. two revisions of a game or
+// two versions of a hack.
+//
+// Equal stretches are skipped with a vector block compare (AVX2 or SSE2,
+// picked at runtime) that only looks for the exact position once a block
+// differs, so the cost is dominated by memory bandwidth. Differing bytes
+// are grouped into ranges, ranges whose surroundings look like BGR555
+// palettes are flagged, and bytes past the end of the shorter image form
+// one final range.
+class RomDiff
+{
+public:
+    static QList<RomDiffRange> compare(QByteArrayView before, QByteArrayView after,
+                                       const RomDiffOptions &options = RomDiffOptions());
+
+    static qsizetype mismatch(const uchar *a, const uchar *b, qsizetype length);
+
+    // Before and after palette strips of a range side by side, each laid out
+    // like PaletteEngine::getImageFromBin(). Palette-like ranges are widened
+    // to whole 16 color rows.
+    static QImage renderRange(QByteArrayView before, QByteArrayView after, const RomDiffRange &range, quint32 rowWidth);
+
+    // CSV with one line per range: file offset, bus address (when mapped),
+    // length, palette flag and the before/after bytes, as BGR555 words for
+    // palette-like ranges.
+    static bool writeReport(QIODevice *device, QByteArrayView before, QByteArrayView after,
+                            const QList<RomDiffRange> &ranges, const AddressMapper &mapper, QString &errorString);
+};
+
+#endif // ROMDIFF_H
@@ -0,0 +1,45 @@
+#include "romdiff_p.h"
+
+#include <QtAlgorithms>
+
+#include <immintrin.h>
+
+qsizetype findMismatch_avx2(const uchar *a, const uchar *b, qsizetype length)
+{
+    qsizetype i = 0;
+
+    // 128 bytes per iteration; the exact position is only looked for once
+    // a block is known to differ.
+    for (; i + 128 <= length; i += 128)
+    {
+        __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                       _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+        __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i + 32)),
+                                       _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + 32)));
+        __m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i + 64)),
+                                       _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + 64)));
+        __m256i e3 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i + 96)),
+                                       _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + 96)));
+
+        __m256i all = _mm256_and_si256(_mm256_and_si256(e0, e1), _mm256_and_si256(e2, e3));
+
+        if (quint32(_mm256_movemask_epi8(all)) != 0xFFFFFFFFu)
+        {
+            break;
+        }
+    }
+
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+        quint32 mask = quint32(_mm256_movemask_epi8(equal));
+
+        if (mask != 0xFFFFFFFFu)
+        {
+            return i + qCountTrailingZeroBits(~mask);
+        }
+    }
+
+    return i + findMismatch_scalar(a + i, b + i, length - i);
+}
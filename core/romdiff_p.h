@@ -0,0 +1,16 @@
+#ifndef ROMDIFF_P_H
+#define ROMDIFF_P_H
+
+#include <QtGlobal>
+
+// Kernel entry points behind RomDiff::mismatch(). Each returns the index of
+// the first byte where a and b differ, or length when they are equal. The
+// SIMD variants finish their tails with the scalar one.
+qsizetype findMismatch_scalar(const uchar *a, const uchar *b, qsizetype length);
+
+#if defined(SPI_X86_SIMD)
+qsizetype findMismatch_sse2(const uchar *a, const uchar *b, qsizetype length);
+qsizetype findMismatch_avx2(const uchar *a, const uchar *b, qsizetype length);
+#endif
+
+#endif // ROMDIFF_P_H
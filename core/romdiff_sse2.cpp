@@ -0,0 +1,45 @@
+#include "romdiff_p.h"
+
+#include <QtAlgorithms>
+
+#include <emmintrin.h>
+
+qsizetype findMismatch_sse2(const uchar *a, const uchar *b, qsizetype length)
+{
+    qsizetype i = 0;
+
+    // 64 bytes per iteration; the exact position is only looked for once
+    // a block is known to differ.
+    for (; i + 64 <= length; i += 64)
+    {
+        __m128i e0 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+        __m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i + 16)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i + 16)));
+        __m128i e2 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i + 32)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i + 32)));
+        __m128i e3 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i + 48)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i + 48)));
+
+        __m128i all = _mm_and_si128(_mm_and_si128(e0, e1), _mm_and_si128(e2, e3));
+
+        if (_mm_movemask_epi8(all) != 0xFFFF)
+        {
+            break;
+        }
+    }
+
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+        quint32 mask = quint32(_mm_movemask_epi8(equal));
+
+        if (mask != 0xFFFF)
+        {
+            return i + qCountTrailingZeroBits(~mask);
+        }
+    }
+
+    return i + findMismatch_scalar(a + i, b + i, length - i);
+}
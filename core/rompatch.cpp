@@ -0,0 +1,544 @@
+#include "rompatch.h"
+#include "crc32.h"
+
+#include <QFileInfo>
+
+#include <cstring>
+
+static const qsizetype ipsMaxOffset = 0xFFFFFF;
+static const qsizetype ipsMaxRecord = 0xFFFF;
+static const qsizetype ipsEofOffset = 0x454F46;
+
+namespace
+{
+
+// Writes to a device while keeping a running CRC32 of everything written,
+// which BPS needs for its own checksum.
+class PatchStream
+{
+public:
+    explicit PatchStream(QIODevice *device)
+        : device(device)
+        , crc(0)
+        , ok(true)
+    {
+    }
+
+    void write(const void *data, qsizetype length)
+    {
+        crc = crc32(data, length, crc);
+        ok = ok && device->write(static_cast<const char *>(data), length) == length;
+    }
+
+    void writeByte(uchar value)
+    {
+        write(&value, 1);
+    }
+
+    void writeBigEndian(quint32 value, int byteCount)
+    {
+        for (int i = byteCount - 1; i >= 0; i--)
+        {
+            writeByte(uchar(value >> (i * 8)));
+        }
+    }
+
+    void writeLittleEndian32(quint32 value)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            writeByte(uchar(value >> (i * 8)));
+        }
+    }
+
+    // BPS variable length number.
+    void writeNumber(quint64 value)
+    {
+        while (true)
+        {
+            uchar low = value & 0x7F;
+            value >>= 7;
+
+            if (value == 0)
+            {
+                writeByte(0x80 | low);
+                break;
+            }
+
+            writeByte(low);
+            value--;
+        }
+    }
+
+    QIODevice *device;
+    quint32 crc;
+    bool ok;
+};
+
+
+
+// Reads from a device while keeping a running CRC32 of everything read.
+// Any short read clears ok and makes every later read fail.
+class PatchInput
+{
+public:
+    explicit PatchInput(QIODevice *device)
+        : device(device)
+        , crc(0)
+        , ok(true)
+    {
+    }
+
+    bool read(void *data, qsizetype length)
+    {
+        ok = ok && device->read(static_cast<char *>(data), length) == length;
+
+        if (ok)
+        {
+            crc = crc32(data, length, crc);
+        }
+
+        return ok;
+    }
+
+    uchar readByte()
+    {
+        uchar value = 0;
+        read(&value, 1);
+        return value;
+    }
+
+    quint32 readBigEndian(int byteCount)
+    {
+        quint32 value = 0;
+
+        for (int i = 0; i < byteCount; i++)
+        {
+            value = (value << 8) | readByte();
+        }
+
+        return value;
+    }
+
+    quint32 readLittleEndian32()
+    {
+        quint32 value = 0;
+
+        for (int i = 0; i < 4; i++)
+        {
+            value |= quint32(readByte()) << (i * 8);
+        }
+
+        return value;
+    }
+
+    // BPS variable length number.
+    quint64 readNumber()
+    {
+        quint64 value = 0;
+        quint64 shift = 1;
+
+        while (ok)
+        {
+            uchar byte = readByte();
+            value += (byte & 0x7F) * shift;
+
+            if (byte & 0x80)
+            {
+                break;
+            }
+
+            if (shift > (quint64(1) << 48))
+            {
+                ok = false;
+                break;
+            }
+
+            shift <<= 7;
+            value += shift;
+        }
+
+        return value;
+    }
+
+    qint64 position() const
+    {
+        return device->pos();
+    }
+
+    QIODevice *device;
+    quint32 crc;
+    bool ok;
+};
+
+}
+
+
+
+PatchFormat RomPatch::formatForPath(const QString &patchPath)
+{
+    return QFileInfo(patchPath).suffix().compare("bps", Qt::CaseInsensitive) == 0 ? PatchFormat::Bps : PatchFormat::Ips;
+}
+
+
+
+bool RomPatch::writeIps(QIODevice *device, QByteArrayView target, const ByteRangeSet &changedRanges, QString &errorString)
+{
+    PatchStream stream(device);
+    stream.write("PATCH", 5);
+
+    for (const ByteRange &range : changedRanges.ranges())
+    {
+        const qsizetype end = qMin(range.end(), target.size());
+        qsizetype offset = range.offset;
+
+        while (offset < end)
+        {
+            // A record at 0x454F46 would read as the "EOF" marker, so it
+            // starts one byte early instead.
+            if (offset == ipsEofOffset)
+            {
+                offset--;
+            }
+
+            if (offset > ipsMaxOffset)
+            {
+                errorString = "ROM is too large for an IPS patch.";
+                return false;
+            }
+
+            qsizetype length = qMin(ipsMaxRecord, end - offset);
+
+            stream.writeBigEndian(quint32(offset), 3);
+            stream.writeBigEndian(quint32(length), 2);
+            stream.write(target.data() + offset, length);
+
+            offset += length;
+        }
+    }
+
+    stream.write("EOF", 3);
+
+    if (!stream.ok)
+    {
+        errorString = "Failed to write patch file.";
+        return false;
+    }
+
+    return true;
+}
+
+
+
+bool RomPatch::writeBps(QIODevice *device, qsizetype sourceSize, quint32 sourceCrc,
+                        QByteArrayView target, const ByteRangeSet &changedRanges, QString &errorString)
+{
+    enum { SourceRead = 0, TargetRead = 1 };
+
+    PatchStream stream(device);
+    qsizetype position = 0;
+
+    auto writeAction = [&stream](int action, qsizetype length)
+    {
+        stream.writeNumber((quint64(length - 1) << 2) | action);
+    };
+
+    auto writeTargetRead = [&](qsizetype end)
+    {
+        if (end > position)
+        {
+            writeAction(TargetRead, end - position);
+            stream.write(target.data() + position, end - position);
+            position = end;
+        }
+    };
+
+    // Unchanged bytes are copied from the source where it has them.
+    auto writeUnchanged = [&](qsizetype end)
+    {
+        qsizetype sourceEnd = qMin(end, sourceSize);
+
+        if (sourceEnd > position)
+        {
+            writeAction(SourceRead, sourceEnd - position);
+            position = sourceEnd;
+        }
+
+        writeTargetRead(end);
+    };
+
+    stream.write("BPS1", 4);
+    stream.writeNumber(sourceSize);
+    stream.writeNumber(target.size());
+    stream.writeNumber(0);
+
+    for (const ByteRange &range : changedRanges.ranges())
+    {
+        if (range.offset >= target.size())
+        {
+            break;
+        }
+
+        writeUnchanged(range.offset);
+        writeTargetRead(qMin(range.end(), target.size()));
+    }
+
+    writeUnchanged(target.size());
+
+    stream.writeLittleEndian32(sourceCrc);
+    stream.writeLittleEndian32(crc32(target));
+
+    const quint32 patchCrc = stream.crc;
+    stream.writeLittleEndian32(patchCrc);
+
+    if (!stream.ok)
+    {
+        errorString = "Failed to write patch file.";
+        return false;
+    }
+
+    return true;
+}
+
+
+
+bool RomPatch::apply(QIODevice *patch, RomStorage &rom, ByteRangeSet &changedRanges, QString &errorString)
+{
+    const QByteArray magic = patch->peek(5);
+
+    if (magic == "PATCH")
+    {
+        return applyIps(patch, rom, changedRanges, errorString);
+    }
+
+    if (magic.startsWith("BPS1"))
+    {
+        return applyBps(patch, rom, changedRanges, errorString);
+    }
+
+    errorString = "Unknown patch format.";
+    return false;
+}
+
+
+
+bool RomPatch::applyIps(QIODevice *patch, RomStorage &rom, ByteRangeSet &changedRanges, QString &errorString)
+{
+    PatchInput input(patch);
+    char header[5];
+    input.read(header, 5);
+
+    while (input.ok)
+    {
+        char offsetBytes[3];
+
+        if (!input.read(offsetBytes, 3))
+        {
+            break;
+        }
+
+        if (memcmp(offsetBytes, "EOF", 3) == 0)
+        {
+            // Optional truncation extension: three more bytes of new size.
+            char sizeBytes[3];
+
+            if (patch->read(sizeBytes, 3) == 3)
+            {
+                qsizetype newSize = (uchar(sizeBytes[0]) << 16) | (uchar(sizeBytes[1]) << 8) | uchar(sizeBytes[2]);
+
+                if (newSize > 0 && newSize < rom.size())
+                {
+                    rom.resize(newSize);
+                }
+            }
+
+            return true;
+        }
+
+        const qsizetype offset = (uchar(offsetBytes[0]) << 16) | (uchar(offsetBytes[1]) << 8) | uchar(offsetBytes[2]);
+        qsizetype length = input.readBigEndian(2);
+        bool run = false;
+        uchar runValue = 0;
+
+        if (length == 0)
+        {
+            length = input.readBigEndian(2);
+            runValue = input.readByte();
+            run = true;
+        }
+
+        if (!input.ok)
+        {
+            break;
+        }
+
+        if (offset + length > rom.size())
+        {
+            rom.resize(offset + length);
+        }
+
+        if (run)
+        {
+            memset(rom.data() + offset, runValue, length);
+        }
+        else if (!input.read(rom.data() + offset, length))
+        {
+            break;
+        }
+
+        changedRanges.add(offset, length);
+    }
+
+    errorString = "IPS patch is truncated.";
+    return false;
+}
+
+
+
+bool RomPatch::applyBps(QIODevice *patch, RomStorage &rom, ByteRangeSet &changedRanges, QString &errorString)
+{
+    enum { SourceRead = 0, TargetRead = 1, SourceCopy = 2, TargetCopy = 3 };
+
+    const qint64 patchSize = patch->size();
+
+    if (patchSize < 4 + 3 + 12)
+    {
+        errorString = "BPS patch is truncated.";
+        return false;
+    }
+
+    // The checksums sit at the end; check the source before doing any work.
+    const qint64 start = patch->pos();
+    char footer[12];
+
+    if (!patch->seek(start + patchSize - 12) || patch->read(footer, 12) != 12 || !patch->seek(start))
+    {
+        errorString = "Failed to read BPS patch.";
+        return false;
+    }
+
+    auto footerValue = [&footer](int index)
+    {
+        const uchar *bytes = reinterpret_cast<const uchar *>(footer) + index * 4;
+        return quint32(bytes[0]) | (quint32(bytes[1]) << 8) | (quint32(bytes[2]) << 16) | (quint32(bytes[3]) << 24);
+    };
+
+    const QByteArrayView source = rom.view(0, rom.size());
+    PatchInput input(patch);
+    char header[4];
+    input.read(header, 4);
+
+    const quint64 sourceSize = input.readNumber();
+    const quint64 targetSize = input.readNumber();
+    const quint64 metadataSize = input.readNumber();
+
+    if (!input.ok || sourceSize != quint64(source.size()) || crc32(source) != footerValue(0))
+    {
+        errorString = "BPS patch does not match this ROM (source checksum mismatch).";
+        return false;
+    }
+
+    if (targetSize == 0 || targetSize > quint64(1) << 30 || metadataSize > quint64(patchSize))
+    {
+        errorString = "BPS patch is corrupt.";
+        return false;
+    }
+
+    QByteArray metadata(metadataSize, Qt::Uninitialized);
+    input.read(metadata.data(), metadata.size());
+
+    QByteArray target(targetSize, Qt::Uninitialized);
+    uchar *output = reinterpret_cast<uchar *>(target.data());
+    const qint64 actionsEnd = start + patchSize - 12;
+    qsizetype outputOffset = 0;
+    qint64 sourceRelative = 0;
+    qint64 targetRelative = 0;
+    bool valid = input.ok;
+
+    while (valid && input.position() < actionsEnd)
+    {
+        const quint64 action = input.readNumber();
+        const qsizetype length = qsizetype(action >> 2) + 1;
+        const int command = action & 3;
+
+        if (!input.ok || length > target.size() - outputOffset)
+        {
+            valid = false;
+            break;
+        }
+
+        switch (command)
+        {
+        case SourceRead:
+            valid = outputOffset + length <= source.size();
+
+            if (valid)
+            {
+                memcpy(output + outputOffset, source.data() + outputOffset, length);
+            }
+
+            break;
+
+        case TargetRead:
+            valid = input.read(output + outputOffset, length);
+            break;
+
+        case SourceCopy:
+        {
+            const quint64 delta = input.readNumber();
+            sourceRelative += (delta & 1 ? -1 : 1) * qint64(delta >> 1);
+            valid = input.ok && sourceRelative >= 0 && sourceRelative + length <= source.size();
+
+            if (valid)
+            {
+                memcpy(output + outputOffset, source.data() + sourceRelative, length);
+                sourceRelative += length;
+            }
+
+            break;
+        }
+
+        case TargetCopy:
+        {
+            const quint64 delta = input.readNumber();
+            targetRelative += (delta & 1 ? -1 : 1) * qint64(delta >> 1);
+            valid = input.ok && targetRelative >= 0 && targetRelative < outputOffset;
+
+            // Copies may overlap their own output (run-length style), so
+            // this has to go byte by byte.
+            for (qsizetype i = 0; valid && i < length; i++)
+            {
+                output[outputOffset + i] = output[targetRelative++];
+            }
+
+            break;
+        }
+        }
+
+        if (valid && command != SourceRead)
+        {
+            changedRanges.add(outputOffset, length);
+        }
+
+        outputOffset += length;
+    }
+
+    if (!valid || outputOffset != target.size() || input.position() != actionsEnd)
+    {
+        errorString = "BPS patch is corrupt.";
+        return false;
+    }
+
+    input.readLittleEndian32();
+    input.readLittleEndian32();
+    const quint32 patchCrc = input.crc;
+
+    if (!input.ok || crc32(target) != footerValue(1) || patchCrc != footerValue(2))
+    {
+        errorString = "BPS patch failed its checksum check.";
+        return false;
+    }
+
+    rom.setContents(target);
+    return true;
+}
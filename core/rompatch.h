@@ -0,0 +1,45 @@
+#ifndef ROMPATCH_H
+#define ROMPATCH_H
+
+#include <QByteArrayView>
+#include <QIODevice>
+#include <QString>
+
+#include "byterangeset.h"
+#include "romstorage.h"
+
+enum class PatchFormat
+{
+    Ips,
+    Bps
+};
+
+// IPS and BPS patch support.
+//
+// Writers only read target inside changedRanges and treat every other byte
+// as equal to the source, so a patch for thousands of scattered palette
+// edits is streamed straight to the device without building a copy or diff
+// of either ROM. apply() reads a patch once, front to back: IPS records are
+// read straight into the ROM image, BPS builds its target in a single pass
+// and checks the source, target and patch CRC32s. Failing calls return
+// false with a message in errorString.
+class RomPatch
+{
+public:
+    static PatchFormat formatForPath(const QString &patchPath);
+
+    // Patches rom in place, resizing it if the patch asks for it, and adds
+    // every byte the patch wrote to changedRanges. The format is taken from
+    // the patch header. On failure rom may be partially patched.
+    static bool apply(QIODevice *patch, RomStorage &rom, ByteRangeSet &changedRanges, QString &errorString);
+
+    static bool writeIps(QIODevice *device, QByteArrayView target, const ByteRangeSet &changedRanges, QString &errorString);
+    static bool writeBps(QIODevice *device, qsizetype sourceSize, quint32 sourceCrc,
+                         QByteArrayView target, const ByteRangeSet &changedRanges, QString &errorString);
+
+private:
+    static bool applyIps(QIODevice *patch, RomStorage &rom, ByteRangeSet &changedRanges, QString &errorString);
+    static bool applyBps(QIODevice *patch, RomStorage &rom, ByteRangeSet &changedRanges, QString &errorString);
+};
+
+#endif // ROMPATCH_H
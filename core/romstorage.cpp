@@ -0,0 +1,273 @@
+#include "romstorage.h"
+
+#include <QFileInfo>
+
+#include <cstring>
+
+RomStorage::RomStorage()
+    : mappedData(nullptr)
+    , length(0)
+    , loaded(0)
+{
+}
+
+RomStorage::~RomStorage()
+{
+    close();
+}
+
+
+
+bool RomStorage::open(const QString &filePath)
+{
+    return openDeferred(filePath) && loadRemaining();
+}
+
+
+
+bool RomStorage::loadRemaining()
+{
+    // A mapping is read lazily by the system anyway.
+    if (mappedData != nullptr)
+    {
+        loaded.storeRelease(length);
+        return true;
+    }
+
+    qsizetype chunk;
+
+    do
+    {
+        chunk = loadChunk(length);
+    }
+    while (chunk > 0);
+
+    return chunk == 0;
+}
+
+
+
+// The checks before close() keep the current ROM when the new file is
+// plainly unusable.
+bool RomStorage::openDeferred(const QString &filePath)
+{
+    const QFileInfo fileInfo(filePath);
+
+    if (!fileInfo.isFile() || !fileInfo.isReadable())
+    {
+        lastError = "Failed to open ROM file.";
+        return false;
+    }
+
+    if (fileInfo.size() <= 0)
+    {
+        lastError = "ROM file is empty.";
+        return false;
+    }
+
+    close();
+    file.setFileName(filePath);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        lastError = "Failed to open ROM file.";
+        file.setFileName(QString());
+        return false;
+    }
+
+    const qint64 fileSize = file.size();
+
+    if (fileSize <= 0)
+    {
+        lastError = "ROM file is empty.";
+        close();
+        return false;
+    }
+
+    mappedData = file.map(0, fileSize, QFileDevice::MapPrivateOption);
+
+    if (mappedData == nullptr)
+    {
+        bufferData.resize(fileSize);
+    }
+
+    length = fileSize;
+    return true;
+}
+
+
+
+qsizetype RomStorage::loadChunk(qsizetype maxBytes)
+{
+    const qsizetype first = loaded.loadRelaxed();
+    const qsizetype count = qMin(maxBytes, length - first);
+
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    if (mappedData != nullptr)
+    {
+        // Touch every page so later reads never wait for the disk.
+        volatile uchar sink = 0;
+
+        for (qsizetype offset = first; offset < first + count; offset += 4096)
+        {
+            sink = sink + mappedData[offset];
+        }
+    }
+    else if (file.read(bufferData.data() + first, count) != count)
+    {
+        lastError = "Failed to read ROM file.";
+        return -1;
+    }
+
+    loaded.storeRelease(first + count);
+
+    if (mappedData == nullptr && first + count == length)
+    {
+        file.close();
+    }
+
+    return count;
+}
+
+
+
+qsizetype RomStorage::loadedSize() const
+{
+    return loaded.loadAcquire();
+}
+
+bool RomStorage::isComplete() const
+{
+    return length > 0 && loaded.loadAcquire() == length;
+}
+
+
+
+void RomStorage::close()
+{
+    if (mappedData != nullptr)
+    {
+        file.unmap(mappedData);
+        mappedData = nullptr;
+    }
+
+    if (file.isOpen())
+    {
+        file.close();
+    }
+
+    file.setFileName(QString());
+    bufferData.clear();
+    length = 0;
+    loaded.storeRelease(0);
+}
+
+
+
+void RomStorage::resize(qsizetype newSize)
+{
+    if (mappedData != nullptr)
+    {
+        bufferData = QByteArray(reinterpret_cast<const char *>(mappedData), length);
+        file.unmap(mappedData);
+        mappedData = nullptr;
+        file.close();
+    }
+
+    bufferData.resize(newSize);
+
+    if (newSize > length)
+    {
+        memset(bufferData.data() + length, 0, newSize - length);
+    }
+
+    length = newSize;
+    loaded.storeRelease(newSize);
+}
+
+
+
+void RomStorage::setContents(const QByteArray &contents)
+{
+    if (mappedData != nullptr)
+    {
+        file.unmap(mappedData);
+        mappedData = nullptr;
+        file.close();
+    }
+
+    bufferData = contents;
+    length = contents.size();
+    loaded.storeRelease(length);
+}
+
+
+
+bool RomStorage::isOpen() const
+{
+    return length > 0;
+}
+
+bool RomStorage::isMapped() const
+{
+    return mappedData != nullptr;
+}
+
+QString RomStorage::filePath() const
+{
+    return file.fileName();
+}
+
+qsizetype RomStorage::size() const
+{
+    return length;
+}
+
+QString RomStorage::errorString() const
+{
+    return lastError;
+}
+
+
+
+const uchar *RomStorage::constData() const
+{
+    if (mappedData != nullptr)
+    {
+        return mappedData;
+    }
+
+    return reinterpret_cast<const uchar *>(bufferData.constData());
+}
+
+uchar *RomStorage::data()
+{
+    if (mappedData != nullptr)
+    {
+        return mappedData;
+    }
+
+    return reinterpret_cast<uchar *>(bufferData.data());
+}
+
+
+
+bool RomStorage::contains(qsizetype offset, qsizetype count) const
+{
+    const qsizetype available = loaded.loadAcquire();
+    return offset >= 0 && count >= 0 && offset <= available && count <= available - offset;
+}
+
+QByteArrayView RomStorage::view(qsizetype offset, qsizetype count) const
+{
+    if (!contains(offset, count))
+    {
+        return QByteArrayView();
+    }
+
+    return QByteArrayView(constData() + offset, count);
+}
@@ -0,0 +1,73 @@
+#ifndef ROMSTORAGE_H
+#define ROMSTORAGE_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+
+// Backing store for an opened ROM.
+//
+// The file is mapped with a private (copy-on-write) mapping: pages are only
+// read from disk when first touched, and writing through data() copies just
+// the affected pages into anonymous memory while the file stays untouched.
+// Opening many large ROMs with open() therefore costs next to no resident
+// memory until they are actually read or edited. loadChunk() is the
+// exception: it touches every page it covers, so a window loading a ROM
+// in the background never waits for the disk afterwards. Files that
+// cannot be mapped (some network filesystems) fall back to an in-memory
+// copy.
+class RomStorage
+{
+public:
+    RomStorage();
+    ~RomStorage();
+
+    bool open(const QString &filePath);
+    void close();
+
+    // open() returns with the whole file readable. openDeferred() only
+    // opens (and if possible maps) it; loadChunk() then brings the bytes in
+    // front to back and may run on another thread, while contains() and
+    // view() only accept bytes that have arrived. loadChunk() returns the
+    // number of new bytes, 0 once complete and -1 on a read error.
+    // loadRemaining() finishes the load the way open() does, leaving a
+    // mapping to be paged in as it is used.
+    bool openDeferred(const QString &filePath);
+    qsizetype loadChunk(qsizetype maxBytes);
+    bool loadRemaining();
+    qsizetype loadedSize() const;
+    bool isComplete() const;
+
+    // Both move the image into memory (dropping the mapping) while keeping
+    // the file path; used when patches change the ROM's size or layout.
+    void resize(qsizetype newSize);
+    void setContents(const QByteArray &contents);
+
+    bool isOpen() const;
+    bool isMapped() const;
+    QString filePath() const;
+    qsizetype size() const;
+
+    const uchar *constData() const;
+    uchar *data();
+
+    // Non-owning view; valid until the storage is closed or reopened.
+    QByteArrayView view(qsizetype offset, qsizetype count) const;
+    bool contains(qsizetype offset, qsizetype count) const;
+
+    QString errorString() const;
+
+private:
+    Q_DISABLE_COPY(RomStorage)
+
+    QFile file;
+    uchar *mappedData;
+    QByteArray bufferData;
+    qsizetype length;
+    QAtomicInteger<qsizetype> loaded;
+    QString lastError;
+};
+
+#endif // ROMSTORAGE_H
@@ -0,0 +1,198 @@
+#include "sneschecksum.h"
+
+// Sum of a checksum/complement pair, whatever the checksum is.
+static const quint32 validFieldSum = 0xFF + 0xFF;
+
+
+
+SnesChecksum::SnesChecksum()
+    : header(0)
+    , sum(0)
+{
+}
+
+
+
+// Each part is the largest power of two that fits; what is left is
+// mirrored up to its own next power of two, so its bytes count that many
+// more times.
+void SnesChecksum::reset(qsizetype fileSize, quint32 copierHeader)
+{
+    segments.clear();
+    header = copierHeader;
+    sum = 0;
+
+    qsizetype start = header;
+    qsizetype size = fileSize - header;
+    quint32 weight = 1;
+
+    while (size > 0)
+    {
+        qsizetype part = 1;
+
+        while (part * 2 <= size)
+        {
+            part *= 2;
+        }
+
+        segments.append({ start, start + part, weight });
+
+        const qsizetype rest = size - part;
+        qsizetype mirrored = 1;
+
+        while (mirrored < rest)
+        {
+            mirrored *= 2;
+        }
+
+        weight *= quint32(part / mirrored);
+        start += part;
+        size = rest;
+    }
+}
+
+bool SnesChecksum::isEmpty() const
+{
+    return segments.isEmpty();
+}
+
+
+
+void SnesChecksum::add(qsizetype fileOffset, QByteArrayView bytes)
+{
+    sum += weightedSum(fileOffset, bytes);
+}
+
+void SnesChecksum::replace(qsizetype fileOffset, QByteArrayView before, QByteArrayView after)
+{
+    sum += weightedSum(fileOffset, after) - weightedSum(fileOffset, before);
+}
+
+
+
+qsizetype SnesChecksum::headerOffset(AddressMapMode mode, QByteArrayView romData) const
+{
+    QList<qsizetype> candidates;
+
+    switch (mode)
+    {
+    case AddressMapMode::LoRom:
+    case AddressMapMode::Sa1Rom:
+    case AddressMapMode::Sdd1Rom:
+        candidates << 0x7FC0;
+        break;
+
+    case AddressMapMode::HiRom:
+        candidates << 0xFFC0;
+        break;
+
+    case AddressMapMode::ExLoRom:
+        candidates << 0x407FC0;
+        break;
+
+    case AddressMapMode::ExHiRom:
+        candidates << 0x40FFC0;
+        break;
+
+    case AddressMapMode::None:
+        candidates << 0x7FC0 << 0xFFC0 << 0x40FFC0;
+        break;
+    }
+
+    for (qsizetype candidate : candidates)
+    {
+        const qsizetype offset = candidate + header;
+
+        if (offset + fieldOffset + fieldSize > romData.size())
+        {
+            continue;
+        }
+
+        if (mode != AddressMapMode::None)
+        {
+            return offset;
+        }
+
+        const uchar *field = reinterpret_cast<const uchar *>(romData.data()) + offset + fieldOffset;
+        const quint16 complement = quint16(field[0] | (field[1] << 8));
+        const quint16 stored = quint16(field[2] | (field[3] << 8));
+
+        if (quint16(complement ^ stored) == 0xFFFF)
+        {
+            return offset;
+        }
+    }
+
+    return -1;
+}
+
+
+
+quint16 SnesChecksum::checksum(QByteArrayView romData, qsizetype headerOffset) const
+{
+    const qsizetype offset = headerOffset + fieldOffset;
+    const quint32 weight = weightAt(offset);
+
+    return quint16(sum - weightedSum(offset, romData.sliced(offset, fieldSize)) + validFieldSum * weight);
+}
+
+
+
+QByteArray SnesChecksum::checksumField(quint16 checksum)
+{
+    const quint16 complement = checksum ^ 0xFFFF;
+    QByteArray field(fieldSize, Qt::Uninitialized);
+
+    field[0] = char(complement & 0xFF);
+    field[1] = char(complement >> 8);
+    field[2] = char(checksum & 0xFF);
+    field[3] = char(checksum >> 8);
+    return field;
+}
+
+quint16 SnesChecksum::storedChecksum(QByteArrayView romData, qsizetype headerOffset)
+{
+    const uchar *field = reinterpret_cast<const uchar *>(romData.data()) + headerOffset + fieldOffset;
+    return quint16(field[2] | (field[3] << 8));
+}
+
+
+
+quint32 SnesChecksum::weightAt(qsizetype fileOffset) const
+{
+    for (const Segment &segment : segments)
+    {
+        if (fileOffset >= segment.start && fileOffset < segment.end)
+        {
+            return segment.weight;
+        }
+    }
+
+    return 0;
+}
+
+
+
+// Wraps modulo 2^32, which keeps the low 16 bits exact.
+quint32 SnesChecksum::weightedSum(qsizetype fileOffset, QByteArrayView bytes) const
+{
+    const uchar *data = reinterpret_cast<const uchar *>(bytes.data());
+    const qsizetype end = fileOffset + bytes.size();
+    quint32 total = 0;
+
+    for (const Segment &segment : segments)
+    {
+        const qsizetype first = qMax(fileOffset, segment.start);
+        const qsizetype last = qMin(end, segment.end);
+        quint32 segmentSum = 0;
+
+        for (qsizetype i = first; i < last; i++)
+        {
+            segmentSum += data[i - fileOffset];
+        }
+
+        total += segmentSum * segment.weight;
+    }
+
+    return total;
+}
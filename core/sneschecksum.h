@@ -0,0 +1,60 @@
+#ifndef SNESCHECKSUM_H
+#define SNESCHECKSUM_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+
+#include "addressmapper.h"
+
+// Internal header checksum: the 16-bit sum of every ROM byte, stored with
+// its complement at header + 0x1C/0x1E. A ROM that is not a power of two
+// in size is summed as if its last part were mirrored up to the next
+// power of two, so each byte counts with a fixed weight. The weighted sum
+// is kept as bytes change, which makes checksum() O(1).
+//
+// Offsets are file offsets; bytes of a copier header are not summed.
+class SnesChecksum
+{
+public:
+    SnesChecksum();
+
+    void reset(qsizetype fileSize, quint32 copierHeader);
+    bool isEmpty() const;
+
+    void add(qsizetype fileOffset, QByteArrayView bytes);
+    void replace(qsizetype fileOffset, QByteArrayView before, QByteArrayView after);
+
+    // File offset of the internal header for mode, or -1 if the ROM is too
+    // small to hold one. In None mode the LoROM, HiROM and ExHiROM
+    // locations are tried for a checksum/complement pair.
+    qsizetype headerOffset(AddressMapMode mode, QByteArrayView romData) const;
+
+    // Checksum of romData, counting the checksum and complement fields at
+    // headerOffset as if they were valid.
+    quint16 checksum(QByteArrayView romData, qsizetype headerOffset) const;
+
+    // The complement and checksum, little endian, as stored at
+    // headerOffset + fieldOffset.
+    static const qsizetype fieldOffset = 0x1C;
+    static const qsizetype fieldSize = 4;
+    static QByteArray checksumField(quint16 checksum);
+    static quint16 storedChecksum(QByteArrayView romData, qsizetype headerOffset);
+
+private:
+    struct Segment
+    {
+        qsizetype start;
+        qsizetype end;
+        quint32 weight;
+    };
+
+    QList<Segment> segments;
+    quint32 header;
+    quint32 sum;
+
+    quint32 weightAt(qsizetype fileOffset) const;
+    quint32 weightedSum(qsizetype fileOffset, QByteArrayView bytes) const;
+};
+
+#endif // SNESCHECKSUM_H
@@ -0,0 +1,164 @@
+#include "snescolor.h"
+#include "snescolor_p.h"
+#include "cpufeatures.h"
+
+#include <QtEndian>
+
+QRgb snesToRGB(quint16 snesColor)
+{
+    unsigned char r,g,b;
+
+    r = (((snesColor & 0x1F) << 3) | ((snesColor >> 2) & 0x07));
+    g = ((((snesColor >> 5) & 0x1F) << 3) | ((snesColor >> 7) & 0x07));
+    b = ((((snesColor >> 10) & 0x1F) << 3) | ((snesColor >> 12) & 0x07));
+
+    return qRgba(r, g, b, 255);
+}
+
+quint16 rgbToSNES(QColor color)
+{
+    quint16 snesColor;
+    quint8 red = color.red();
+    quint8 green = color.green();
+    quint8 blue = color.blue();
+
+    snesColor = (red >> 3) | ((green >> 3) << 5) | ((blue >> 3) << 10);
+    return snesColor;
+}
+
+QColor snesToQcolor(quint16 snesColor)
+{
+    unsigned char r,g,b;
+
+    r = (((snesColor & 0x1F) << 3) | ((snesColor >> 2) & 0x07));
+    g = ((((snesColor >> 5) & 0x1F) << 3) | ((snesColor >> 7) & 0x07));
+    b = ((((snesColor >> 10) & 0x1F) << 3) | ((snesColor >> 12) & 0x07));
+
+    return QColor(r, g, b);
+}
+
+
+
+void snesToRGBBulk_scalar(const uchar *snesData, QRgb *rgbData, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; i++)
+    {
+        rgbData[i] = snesToRGB(qFromLittleEndian<quint16>(snesData + i * 2));
+    }
+}
+
+void rgbToSNESBulk_scalar(const QRgb *rgbData, uchar *snesData, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; i++)
+    {
+        QRgb p = rgbData[i];
+        quint16 snesColor = ((p >> 19) & 0x001F) | ((p >> 6) & 0x03E0) | ((p << 7) & 0x7C00);
+        qToLittleEndian<quint16>(snesColor, snesData + i * 2);
+    }
+}
+
+
+
+void snesToRGBBulk(const uchar *snesData, QRgb *rgbData, qsizetype count)
+{
+#if defined(SPI_X86_SIMD)
+    if (cpuHasAVX2())
+    {
+        snesToRGBBulk_avx2(snesData, rgbData, count);
+        return;
+    }
+
+    snesToRGBBulk_sse2(snesData, rgbData, count);
+#else
+    snesToRGBBulk_scalar(snesData, rgbData, count);
+#endif
+}
+
+void rgbToSNESBulk(const QRgb *rgbData, uchar *snesData, qsizetype count)
+{
+#if defined(SPI_X86_SIMD)
+    if (cpuHasAVX2())
+    {
+        rgbToSNESBulk_avx2(rgbData, snesData, count);
+        return;
+    }
+
+    rgbToSNESBulk_sse2(rgbData, snesData, count);
+#else
+    rgbToSNESBulk_scalar(rgbData, snesData, count);
+#endif
+}
+
+
+
+// The packed variants go through a small QRgb buffer so they share the
+// vector kernels above.
+static const qsizetype bulkChunkSize = 1024;
+
+void snesToRGB888Bulk(const uchar *snesData, uchar *rgbData, qsizetype count)
+{
+    QRgb buffer[bulkChunkSize];
+
+    for (qsizetype offset = 0; offset < count; offset += bulkChunkSize)
+    {
+        qsizetype chunk = qMin(bulkChunkSize, count - offset);
+        snesToRGBBulk(snesData + offset * 2, buffer, chunk);
+
+        uchar *out = rgbData + offset * 3;
+
+        for (qsizetype i = 0; i < chunk; i++)
+        {
+            out[i * 3] = qRed(buffer[i]);
+            out[i * 3 + 1] = qGreen(buffer[i]);
+            out[i * 3 + 2] = qBlue(buffer[i]);
+        }
+    }
+}
+
+void rgb888ToSNESBulk(const uchar *rgbData, uchar *snesData, qsizetype count)
+{
+    QRgb buffer[bulkChunkSize];
+
+    for (qsizetype offset = 0; offset < count; offset += bulkChunkSize)
+    {
+        qsizetype chunk = qMin(bulkChunkSize, count - offset);
+        const uchar *in = rgbData + offset * 3;
+
+        for (qsizetype i = 0; i < chunk; i++)
+        {
+            buffer[i] = qRgb(in[i * 3], in[i * 3 + 1], in[i * 3 + 2]);
+        }
+
+        rgbToSNESBulk(buffer, snesData + offset * 2, chunk);
+    }
+}
+
+
+
+quint32 hexStringToInt(QString string)
+{
+    bool convertOK;
+    quint32 integer = string.toInt(&convertOK, 16);
+
+    if (convertOK) {
+        return integer;
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+quint32 stringToInt(QString string)
+{
+    bool convertOK;
+    quint32 integer = string.toInt(&convertOK, 10);
+
+    if (convertOK) {
+        return integer;
+    }
+    else
+    {
+        return 0;
+    }
+}
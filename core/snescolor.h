@@ -0,0 +1,27 @@
+#ifndef SNESCOLOR_H
+#define SNESCOLOR_H
+
+#include <QColor>
+#include <QRgb>
+#include <QString>
+
+// Conversions between SNES BGR555 words and 24 bit RGB.
+QRgb snesToRGB(quint16 snesColor);
+quint16 rgbToSNES(QColor color);
+QColor snesToQcolor(quint16 snesColor);
+
+// Bulk conversions over whole palettes or ROM regions. SNES colors are read
+// and written as little endian words at any byte alignment; QRgb values use
+// the QImage::Format_RGB32/ARGB32 layout and alpha is ignored on input. The
+// SSE2/AVX2 kernels produce exactly the same output as the scalar ones.
+void snesToRGBBulk(const uchar *snesData, QRgb *rgbData, qsizetype count);
+void rgbToSNESBulk(const QRgb *rgbData, uchar *snesData, qsizetype count);
+
+// Packed 3 byte R,G,B triplets, as stored in .pal files.
+void snesToRGB888Bulk(const uchar *snesData, uchar *rgbData, qsizetype count);
+void rgb888ToSNESBulk(const uchar *rgbData, uchar *snesData, qsizetype count);
+
+quint32 hexStringToInt(QString string);
+quint32 stringToInt(QString string);
+
+#endif // SNESCOLOR_H
@@ -0,0 +1,68 @@
+#include "snescolor_p.h"
+
+#include <immintrin.h>
+
+void snesToRGBBulk_avx2(const uchar *snesData, QRgb *rgbData, qsizetype count)
+{
+    const __m256i mask5 = _mm256_set1_epi16(0x1F);
+    const __m256i alpha = _mm256_set1_epi16(short(0xFF00));
+    qsizetype i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(snesData + i * 2));
+
+        __m256i r = _mm256_and_si256(c, mask5);
+        __m256i g = _mm256_and_si256(_mm256_srli_epi16(c, 5), mask5);
+        __m256i b = _mm256_and_si256(_mm256_srli_epi16(c, 10), mask5);
+
+        r = _mm256_or_si256(_mm256_slli_epi16(r, 3), _mm256_srli_epi16(r, 2));
+        g = _mm256_or_si256(_mm256_slli_epi16(g, 3), _mm256_srli_epi16(g, 2));
+        b = _mm256_or_si256(_mm256_slli_epi16(b, 3), _mm256_srli_epi16(b, 2));
+
+        __m256i lo = _mm256_or_si256(b, _mm256_slli_epi16(g, 8));
+        __m256i hi = _mm256_or_si256(r, alpha);
+
+        // Unpacking works per 128 bit lane: colors 0-3/8-11 and 4-7/12-15.
+        __m256i a = _mm256_unpacklo_epi16(lo, hi);
+        __m256i d = _mm256_unpackhi_epi16(lo, hi);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgbData + i), _mm256_permute2x128_si256(a, d, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgbData + i + 8), _mm256_permute2x128_si256(a, d, 0x31));
+    }
+
+    snesToRGBBulk_scalar(snesData + i * 2, rgbData + i, count - i);
+}
+
+
+
+static inline __m256i packSNES_avx2(__m256i p)
+{
+    const __m256i maskR = _mm256_set1_epi32(0x001F);
+    const __m256i maskG = _mm256_set1_epi32(0x03E0);
+    const __m256i maskB = _mm256_set1_epi32(0x7C00);
+
+    __m256i r = _mm256_and_si256(_mm256_srli_epi32(p, 19), maskR);
+    __m256i g = _mm256_and_si256(_mm256_srli_epi32(p, 6), maskG);
+    __m256i b = _mm256_and_si256(_mm256_slli_epi32(p, 7), maskB);
+
+    return _mm256_or_si256(r, _mm256_or_si256(g, b));
+}
+
+void rgbToSNESBulk_avx2(const QRgb *rgbData, uchar *snesData, qsizetype count)
+{
+    qsizetype i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rgbData + i));
+        __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rgbData + i + 8));
+
+        // packs works per lane, leaving the quadwords in 0,2,1,3 order.
+        __m256i packed = _mm256_packs_epi32(packSNES_avx2(p0), packSNES_avx2(p1));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(snesData + i * 2), packed);
+    }
+
+    rgbToSNESBulk_scalar(rgbData + i, snesData + i * 2, count - i);
+}
@@ -0,0 +1,19 @@
+#ifndef SNESCOLOR_P_H
+#define SNESCOLOR_P_H
+
+#include <QRgb>
+
+// Kernel entry points behind snesToRGBBulk()/rgbToSNESBulk(). The SIMD
+// variants finish their tails with the scalar ones so every path agrees
+// bit for bit.
+void snesToRGBBulk_scalar(const uchar *snesData, QRgb *rgbData, qsizetype count);
+void rgbToSNESBulk_scalar(const QRgb *rgbData, uchar *snesData, qsizetype count);
+
+#if defined(SPI_X86_SIMD)
+void snesToRGBBulk_sse2(const uchar *snesData, QRgb *rgbData, qsizetype count);
+void rgbToSNESBulk_sse2(const QRgb *rgbData, uchar *snesData, qsizetype count);
+void snesToRGBBulk_avx2(const uchar *snesData, QRgb *rgbData, qsizetype count);
+void rgbToSNESBulk_avx2(const QRgb *rgbData, uchar *snesData, qsizetype count);
+#endif
+
+#endif // SNESCOLOR_P_H
@@ -0,0 +1,65 @@
+#include "snescolor_p.h"
+
+#include <emmintrin.h>
+
+void snesToRGBBulk_sse2(const uchar *snesData, QRgb *rgbData, qsizetype count)
+{
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i alpha = _mm_set1_epi16(short(0xFF00));
+    qsizetype i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(snesData + i * 2));
+
+        __m128i r = _mm_and_si128(c, mask5);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(c, 5), mask5);
+        __m128i b = _mm_and_si128(_mm_srli_epi16(c, 10), mask5);
+
+        // Expand 5 to 8 bits by replicating the top bits into the bottom.
+        r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+        g = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+        b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+        // 0xAARRGGBB: low word GGBB, high word AARR.
+        __m128i lo = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+        __m128i hi = _mm_or_si128(r, alpha);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(rgbData + i), _mm_unpacklo_epi16(lo, hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(rgbData + i + 4), _mm_unpackhi_epi16(lo, hi));
+    }
+
+    snesToRGBBulk_scalar(snesData + i * 2, rgbData + i, count - i);
+}
+
+
+
+static inline __m128i packSNES_sse2(__m128i p)
+{
+    const __m128i maskR = _mm_set1_epi32(0x001F);
+    const __m128i maskG = _mm_set1_epi32(0x03E0);
+    const __m128i maskB = _mm_set1_epi32(0x7C00);
+
+    __m128i r = _mm_and_si128(_mm_srli_epi32(p, 19), maskR);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(p, 6), maskG);
+    __m128i b = _mm_and_si128(_mm_slli_epi32(p, 7), maskB);
+
+    return _mm_or_si128(r, _mm_or_si128(g, b));
+}
+
+void rgbToSNESBulk_sse2(const QRgb *rgbData, uchar *snesData, qsizetype count)
+{
+    qsizetype i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgbData + i));
+        __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgbData + i + 4));
+
+        // Every result is below 0x8000, so signed saturation is lossless.
+        __m128i packed = _mm_packs_epi32(packSNES_sse2(p0), packSNES_sse2(p1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(snesData + i * 2), packed);
+    }
+
+    rgbToSNESBulk_scalar(rgbData + i, snesData + i * 2, count - i);
+}
@@ -0,0 +1,15 @@
+# Links the spicore static library built by core.pro. The top-level
+# project builds core first.
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SPICORE_DIR = $$shadowed($$PWD)
+
+win32:CONFIG(release, debug|release): SPICORE_DIR = $$SPICORE_DIR/release
+else:win32:CONFIG(debug, debug|release): SPICORE_DIR = $$SPICORE_DIR/debug
+
+LIBS += -L$$SPICORE_DIR -lspicore
+
+win32:!win32-g++: PRE_TARGETDEPS += $$SPICORE_DIR/spicore.lib
+else: PRE_TARGETDEPS += $$SPICORE_DIR/libspicore.a
@@ -0,0 +1,485 @@
+#include "tilequantizer.h"
+
+#include <QAtomicInteger>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <climits>
+#include <numeric>
+
+static const quint32 tileSize = 8;
+
+namespace
+{
+
+struct TileColors
+{
+    QList<quint16> colors;
+    QList<quint32> counts;
+};
+
+struct WeightedColor
+{
+    quint16 color;
+    quint32 weight;
+};
+
+}
+
+
+
+static inline int channel(quint16 color, int index)
+{
+    return (color >> (index * 5)) & 0x1F;
+}
+
+
+
+// Squared distance between two BGR555 colors, weighted roughly by how
+// sensitive the eye is to each channel.
+static inline int colorDistance(quint16 a, quint16 b)
+{
+    int dr = channel(a, 0) - channel(b, 0);
+    int dg = channel(a, 1) - channel(b, 1);
+    int db = channel(a, 2) - channel(b, 2);
+    return 3 * dr * dr + 4 * dg * dg + 2 * db * db;
+}
+
+
+
+static quint64 tileError(const TileColors &tile, const QList<quint16> &palette)
+{
+    quint64 error = 0;
+
+    for (qsizetype i = 0; i < tile.colors.size(); i++)
+    {
+        int best = INT_MAX;
+
+        for (quint16 paletteColor : palette)
+        {
+            best = qMin(best, colorDistance(tile.colors.at(i), paletteColor));
+        }
+
+        error += quint64(best) * tile.counts.at(i);
+    }
+
+    return error;
+}
+
+
+
+static quint16 weightedMean(const WeightedColor *first, const WeightedColor *last)
+{
+    quint64 sums[3] = { 0, 0, 0 };
+    quint64 total = 0;
+
+    for (const WeightedColor *entry = first; entry != last; entry++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            sums[c] += quint64(channel(entry->color, c)) * entry->weight;
+        }
+
+        total += entry->weight;
+    }
+
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    quint16 mean = 0;
+
+    for (int c = 0; c < 3; c++)
+    {
+        mean |= quint16((sums[c] + total / 2) / total) << (c * 5);
+    }
+
+    return mean;
+}
+
+
+
+// Median cut over a weighted color set, followed by two Lloyd passes.
+static QList<quint16> buildPalette(QList<WeightedColor> entries, quint32 colorCount)
+{
+    QList<quint16> palette;
+
+    if (quint32(entries.size()) <= colorCount)
+    {
+        for (const WeightedColor &entry : entries)
+        {
+            palette.append(entry.color);
+        }
+
+        return palette;
+    }
+
+    struct Box
+    {
+        qsizetype begin;
+        qsizetype end;
+    };
+
+    QList<Box> boxes = { { 0, entries.size() } };
+
+    while (quint32(boxes.size()) < colorCount)
+    {
+        int bestBox = -1;
+        int bestChannel = 0;
+        int bestRange = 0;
+
+        for (int b = 0; b < boxes.size(); b++)
+        {
+            if (boxes.at(b).end - boxes.at(b).begin < 2)
+            {
+                continue;
+            }
+
+            for (int c = 0; c < 3; c++)
+            {
+                int low = 31;
+                int high = 0;
+
+                for (qsizetype i = boxes.at(b).begin; i < boxes.at(b).end; i++)
+                {
+                    low = qMin(low, channel(entries.at(i).color, c));
+                    high = qMax(high, channel(entries.at(i).color, c));
+                }
+
+                if (high - low > bestRange)
+                {
+                    bestRange = high - low;
+                    bestBox = b;
+                    bestChannel = c;
+                }
+            }
+        }
+
+        if (bestBox < 0)
+        {
+            break;
+        }
+
+        Box box = boxes.at(bestBox);
+        WeightedColor *first = entries.data() + box.begin;
+        WeightedColor *last = entries.data() + box.end;
+
+        std::sort(first, last, [bestChannel](const WeightedColor &a, const WeightedColor &b)
+                  {
+                      return channel(a.color, bestChannel) < channel(b.color, bestChannel);
+                  });
+
+        quint64 total = 0;
+
+        for (WeightedColor *entry = first; entry != last; entry++)
+        {
+            total += entry->weight;
+        }
+
+        quint64 running = 0;
+        qsizetype split = box.begin + 1;
+
+        for (qsizetype i = box.begin; i < box.end - 1; i++)
+        {
+            running += entries.at(i).weight;
+            split = i + 1;
+
+            if (running * 2 >= total)
+            {
+                break;
+            }
+        }
+
+        boxes[bestBox] = { box.begin, split };
+        boxes.append({ split, box.end });
+    }
+
+    for (const Box &box : boxes)
+    {
+        palette.append(weightedMean(entries.constData() + box.begin, entries.constData() + box.end));
+    }
+
+    QList<int> nearest(entries.size());
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        QList<quint64> sums(palette.size() * 3, 0);
+        QList<quint64> totals(palette.size(), 0);
+
+        for (qsizetype i = 0; i < entries.size(); i++)
+        {
+            int best = INT_MAX;
+
+            for (int p = 0; p < palette.size(); p++)
+            {
+                int distance = colorDistance(entries.at(i).color, palette.at(p));
+
+                if (distance < best)
+                {
+                    best = distance;
+                    nearest[i] = p;
+                }
+            }
+
+            for (int c = 0; c < 3; c++)
+            {
+                sums[nearest.at(i) * 3 + c] += quint64(channel(entries.at(i).color, c)) * entries.at(i).weight;
+            }
+
+            totals[nearest.at(i)] += entries.at(i).weight;
+        }
+
+        for (int p = 0; p < palette.size(); p++)
+        {
+            if (totals.at(p) == 0)
+            {
+                continue;
+            }
+
+            quint16 mean = 0;
+
+            for (int c = 0; c < 3; c++)
+            {
+                mean |= quint16((sums.at(p * 3 + c) + totals.at(p) / 2) / totals.at(p)) << (c * 5);
+            }
+
+            palette[p] = mean;
+        }
+    }
+
+    return palette;
+}
+
+
+
+bool TileQuantizer::quantize(const QImage &image, const TileQuantizeOptions &options, TileQuantizeResult &result)
+{
+    const quint32 paletteColors = options.colorsPerSubPalette - (options.reserveColorZero ? 1 : 0);
+
+    if (image.isNull() || options.subPaletteCount == 0 || options.subPaletteCount > 256 || paletteColors == 0)
+    {
+        return false;
+    }
+
+    const QImage sheet = image.convertToFormat(QImage::Format_ARGB32);
+    const quint32 width = sheet.width();
+    const quint32 tilesWide = (width + tileSize - 1) / tileSize;
+    const quint32 tilesHigh = (sheet.height() + tileSize - 1) / tileSize;
+
+    // Distinct colors of every tile, one row of tiles per task.
+    QList<TileColors> tiles(tilesWide * tilesHigh);
+    QList<quint32> tileRows(tilesHigh);
+    std::iota(tileRows.begin(), tileRows.end(), 0);
+
+    QtConcurrent::blockingMap(tileRows, [&](quint32 tileRow)
+    {
+        QList<uchar> snesLine(width * 2);
+        const quint32 lastLine = qMin<quint32>(sheet.height(), (tileRow + 1) * tileSize);
+
+        for (quint32 y = tileRow * tileSize; y < lastLine; y++)
+        {
+            const QRgb *line = reinterpret_cast<const QRgb *>(sheet.constScanLine(y));
+            quantizeToSNES(line, snesLine.data(), width, options.quantization, 0, y);
+
+            for (quint32 x = 0; x < width; x++)
+            {
+                if (qAlpha(line[x]) < 128)
+                {
+                    continue;
+                }
+
+                TileColors &tile = tiles[tileRow * tilesWide + x / tileSize];
+                quint16 color = snesLine.at(x * 2) | (snesLine.at(x * 2 + 1) << 8);
+                qsizetype index = tile.colors.indexOf(color);
+
+                if (index < 0)
+                {
+                    tile.colors.append(color);
+                    tile.counts.append(1);
+                }
+                else
+                {
+                    tile.counts[index]++;
+                }
+            }
+        }
+    });
+
+    // Seed the clusters with tiles far apart in average color, starting
+    // from the tile with the most opaque pixels.
+    QList<quint16> tileMeans(tiles.size());
+    QList<quint32> tileWeights(tiles.size(), 0);
+    qsizetype firstSeed = -1;
+
+    for (qsizetype t = 0; t < tiles.size(); t++)
+    {
+        QList<WeightedColor> entries;
+
+        for (qsizetype i = 0; i < tiles.at(t).colors.size(); i++)
+        {
+            entries.append({ tiles.at(t).colors.at(i), tiles.at(t).counts.at(i) });
+            tileWeights[t] += tiles.at(t).counts.at(i);
+        }
+
+        tileMeans[t] = weightedMean(entries.constData(), entries.constData() + entries.size());
+
+        if (tileWeights.at(t) > 0 && (firstSeed < 0 || tileWeights.at(t) > tileWeights.at(firstSeed)))
+        {
+            firstSeed = t;
+        }
+    }
+
+    const quint32 clusterCount = options.subPaletteCount;
+    QList<quint8> assignment(tiles.size(), 0);
+    QList<QList<quint16>> palettes(clusterCount);
+
+    if (firstSeed >= 0)
+    {
+        QList<quint16> seeds = { tileMeans.at(firstSeed) };
+        QList<int> seedDistance(tiles.size(), INT_MAX);
+
+        while (quint32(seeds.size()) < clusterCount)
+        {
+            qsizetype farthest = -1;
+
+            for (qsizetype t = 0; t < tiles.size(); t++)
+            {
+                if (tileWeights.at(t) == 0)
+                {
+                    continue;
+                }
+
+                seedDistance[t] = qMin(seedDistance.at(t), colorDistance(tileMeans.at(t), seeds.last()));
+
+                if (seedDistance.at(t) > 0 && (farthest < 0 || seedDistance.at(t) > seedDistance.at(farthest)))
+                {
+                    farthest = t;
+                }
+            }
+
+            if (farthest < 0)
+            {
+                break;
+            }
+
+            seeds.append(tileMeans.at(farthest));
+        }
+
+        for (qsizetype t = 0; t < tiles.size(); t++)
+        {
+            int best = INT_MAX;
+
+            for (int s = 0; s < seeds.size(); s++)
+            {
+                int distance = colorDistance(tileMeans.at(t), seeds.at(s));
+
+                if (distance < best)
+                {
+                    best = distance;
+                    assignment[t] = s;
+                }
+            }
+        }
+
+        QList<quint32> clusters(clusterCount);
+        std::iota(clusters.begin(), clusters.end(), 0);
+
+        for (int iteration = 0; ; iteration++)
+        {
+            palettes = QtConcurrent::blockingMapped<QList<QList<quint16>>>(clusters, [&](quint32 cluster)
+            {
+                QList<quint32> histogram(32768, 0);
+
+                for (qsizetype t = 0; t < tiles.size(); t++)
+                {
+                    if (assignment.at(t) != cluster)
+                    {
+                        continue;
+                    }
+
+                    for (qsizetype i = 0; i < tiles.at(t).colors.size(); i++)
+                    {
+                        histogram[tiles.at(t).colors.at(i)] += tiles.at(t).counts.at(i);
+                    }
+                }
+
+                QList<WeightedColor> entries;
+
+                for (quint32 color = 0; color < 32768; color++)
+                {
+                    if (histogram.at(color) > 0)
+                    {
+                        entries.append({ quint16(color), histogram.at(color) });
+                    }
+                }
+
+                return buildPalette(entries, paletteColors);
+            });
+
+            if (iteration >= options.iterations)
+            {
+                break;
+            }
+
+            QAtomicInteger<int> moved(0);
+            QList<qsizetype> tileIndexes(tiles.size());
+            std::iota(tileIndexes.begin(), tileIndexes.end(), 0);
+
+            QtConcurrent::blockingMap(tileIndexes, [&](qsizetype t)
+            {
+                if (tileWeights.at(t) == 0)
+                {
+                    return;
+                }
+
+                quint64 bestError = tileError(tiles.at(t), palettes.at(assignment.at(t)));
+                quint8 best = assignment.at(t);
+
+                for (quint32 p = 0; p < clusterCount; p++)
+                {
+                    if (palettes.at(p).isEmpty() || p == assignment.at(t))
+                    {
+                        continue;
+                    }
+
+                    quint64 error = tileError(tiles.at(t), palettes.at(p));
+
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+
+                if (best != assignment.at(t))
+                {
+                    assignment[t] = best;
+                    moved.fetchAndAddRelaxed(1);
+                }
+            });
+
+            if (moved.loadRelaxed() == 0)
+            {
+                break;
+            }
+        }
+    }
+
+    result.colors.fill(0, clusterCount * options.colorsPerSubPalette);
+    result.tileSubPalettes = assignment;
+    result.tilesWide = tilesWide;
+    result.tilesHigh = tilesHigh;
+
+    for (quint32 p = 0; p < clusterCount; p++)
+    {
+        quint32 first = p * options.colorsPerSubPalette + (options.reserveColorZero ? 1 : 0);
+
+        for (qsizetype i = 0; i < palettes.at(p).size(); i++)
+        {
+            result.colors[first + i] = palettes.at(p).at(i);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef TILEQUANTIZER_H
+#define TILEQUANTIZER_H
+
+#include <QImage>
+#include <QList>
+
+#include "colorquantizer.h"
+
+struct TileQuantizeOptions
+{
+    quint32 subPaletteCount = 8;
+    quint32 colorsPerSubPalette = 16;
+
+    // Keep color 0 of every sub-palette for transparency. Only colors
+    // 1-15 are then filled. Pixels with alpha below 128 never count
+    // toward a palette either way.
+    bool reserveColorZero = true;
+
+    int iterations = 8;
+    ColorQuantization quantization = ColorQuantization::Round;
+};
+
+struct TileQuantizeResult
+{
+    // subPaletteCount rows of colorsPerSubPalette BGR555 colors. Reserved
+    // and unused entries are 0.
+    QList<quint16> colors;
+
+    // Sub-palette of every 8x8 tile, row major.
+    QList<quint8> tileSubPalettes;
+    quint32 tilesWide = 0;
+    quint32 tilesHigh = 0;
+};
+
+// Turns a full-color sprite sheet into a set of sub-palettes so that every
+// 8x8 tile can be drawn with a single one of them.
+//
+// Pixels are first reduced to BGR555 and every tile is reduced to a
+// histogram of its distinct colors. Tiles are then clustered k-means style:
+// each cluster gets a palette by median cut over the colors of its tiles
+// (refined with a couple of Lloyd passes), and each tile moves to the
+// palette that draws it with the least error, until no tile moves. Tile
+// histograms, palettes and reassignment all run on every core.
+class TileQuantizer
+{
+public:
+    static bool quantize(const QImage &image, const TileQuantizeOptions &options, TileQuantizeResult &result);
+};
+
+#endif // TILEQUANTIZER_H
@@ -0,0 +1,47 @@
+QT       += core gui concurrent
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++17
+
+TARGET = SNES_Palette_Imager
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+SOURCES += \
+    main.cpp \
+    mainwindow.cpp \
+    palettefilewatcher.cpp \
+    palettepreviewwidget.cpp \
+    paletteprefetcher.cpp \
+    previewrefresher.cpp \
+    romdiffdialog.cpp \
+    romfileworker.cpp
+
+HEADERS += \
+    mainwindow.h \
+    palettefilewatcher.h \
+    palettepreviewwidget.h \
+    paletteprefetcher.h \
+    previewrefresher.h \
+    romdiffdialog.h \
+    romfileworker.h
+
+FORMS += \
+    mainwindow.ui
+
+include(../core/spicore.pri)
+
+TRANSLATIONS += \
+    SNES_Palette_Imager_en_US.ts
+CONFIG += lrelease
+CONFIG += embed_translations
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+RC_ICONS = ../icon.ico
\ No newline at end of file
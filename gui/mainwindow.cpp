@@ -0,0 +1,2183 @@
+#include "mainwindow.h"
+#include "ui_mainwindow.h"
+
+#include <QApplication>
+#include <QDialogButtonBox>
+#include <QElapsedTimer>
+#include <QInputDialog>
+#include <QVBoxLayout>
+
+#include "importmanifest.h"
+
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent)
+    , ui(new Ui::MainWindow)
+{
+    ui->setupUi(this);
+
+    QRegularExpression hexRegex("[0-9A-Fa-f]{6}");
+    ui->addressBox->setValidator(new QRegularExpressionValidator(hexRegex, ui->addressBox));
+
+    ui->rowWidthBox->setValue(16);
+    ui->colorCountBox->setValue(128);
+    colorCountFromImage = false;
+    quickExtract = false;
+
+    ui->addressMapModeBox->addItems(AddressMapper::modeNames());
+    ui->addressMapModeBox->setEnabled(true);
+
+    ui->colorQuantizationBox->addItems(colorQuantizationNames());
+
+    previewRefresher = new PreviewRefresher(this);
+    connect(previewRefresher, &PreviewRefresher::previewReady, this, &MainWindow::showPreview);
+
+    palettePrefetcher = new PalettePrefetcher(engine, this);
+
+    romFileWorker = new RomFileWorker(engine, this);
+    connect(romFileWorker, &RomFileWorker::progress, this, &MainWindow::romFileProgress);
+    connect(romFileWorker, &RomFileWorker::loadFinished, this, &MainWindow::romLoadFinished);
+    connect(romFileWorker, &RomFileWorker::saveFinished, this, &MainWindow::romSaveFinished);
+    connect(romFileWorker, &RomFileWorker::taskFinished, this, &MainWindow::fileTaskFinished);
+    pendingPatchCount = 0;
+
+    fileProgressBar = new QProgressBar(this);
+    fileProgressBar->setMaximumWidth(160);
+    fileProgressBar->setRange(0, 100);
+    cancelFileButton = new QToolButton(this);
+    cancelFileButton->setText(tr("Cancel"));
+    connect(cancelFileButton, &QToolButton::clicked, romFileWorker, &RomFileWorker::cancel);
+    statusBar()->addPermanentWidget(fileProgressBar);
+    statusBar()->addPermanentWidget(cancelFileButton);
+    setFileProgressVisible(false);
+
+    paletteFileWatcher = new PaletteFileWatcher(this);
+    connect(paletteFileWatcher, &PaletteFileWatcher::fileChanged, this, &MainWindow::reloadWatchedFile);
+
+    QString bookmarkError;
+
+    if (!bookmarkIndex.open(BookmarkIndex::defaultPath(), bookmarkError))
+    {
+        updateStatusMessage("ERROR: " + bookmarkError);
+    }
+
+    connect(ui->paletteImageDisplay, &PalettePreviewWidget::scrubRequested, this, &MainWindow::scrubAddress);
+
+    consoleTextTimer = new QTimer(this);
+    connect(consoleTextTimer, &QTimer::timeout, this, &MainWindow::resetConsoleText);
+    consoleTextTimer->setInterval(5000);
+
+    paletteImageWidth = 16;
+    paletteImageHeight = 16;
+    previewScale = 16;
+    paletteImage = QImage(paletteImageWidth, paletteImageHeight, QImage::Format_RGB32);
+    paletteImage.fill(Qt::white);
+
+    ui->paletteImageDisplay->setScale(previewScale);
+    ui->paletteImageDisplay->setImage(paletteImage);
+    connect(ui->paletteImageDisplay, &PalettePreviewWidget::scaleChanged, ui->previewScaleSlider, &QSlider::setValue);
+
+    lastROMPath = QDir::homePath();
+    lastPalettePath = QDir::homePath();
+
+}
+
+MainWindow::~MainWindow()
+{
+    // The prefetch and file workers use the ROM owned by engine.
+    delete romFileWorker;
+    palettePrefetcher->invalidate();
+
+    saveWorkspace();
+    delete ui;
+}
+
+void MainWindow::updateLastFilePath(QString filePath, QDir* path)
+{
+    QFileInfo fileInfo(filePath);
+    QString lastFolderPath = fileInfo.absolutePath();
+    path->setPath(lastFolderPath);
+}
+
+
+
+void MainWindow::updateStatusMessage(QString messageString)
+{
+    qDebug() << messageString;
+    statusBar()->showMessage(messageString, 10000);
+    //consoleTextTimer->start();
+}
+
+
+
+void MainWindow::setRomActionsEnabled(bool enabled)
+{
+    ui->saveRomButton->setEnabled(enabled);
+    ui->saveRomAsButton->setEnabled(enabled);
+    ui->savePatchButton->setEnabled(enabled);
+    ui->exportBinButton->setEnabled(enabled);
+    ui->exportPalButton->setEnabled(enabled);
+    ui->exportPaletteButton->setEnabled(enabled);
+    ui->importBinButton->setEnabled(enabled);
+    ui->importPalButton->setEnabled(enabled);
+    ui->importSheetButton->setEnabled(enabled);
+    ui->importManifestButton->setEnabled(enabled);
+    ui->bulkExtractButton->setEnabled(enabled);
+    ui->importPaletteButton->setEnabled(enabled);
+    ui->loadPaletteButton->setEnabled(enabled);
+    ui->scanRomButton->setEnabled(enabled);
+    ui->findExactButton->setEnabled(enabled);
+    ui->findSimilarButton->setEnabled(enabled);
+    ui->diffRomButton->setEnabled(enabled);
+    ui->scrubModeCheckBox->setEnabled(enabled);
+    ui->scrubStepBox->setEnabled(enabled);
+    ui->addBookmarkButton->setEnabled(enabled);
+    ui->removeBookmarkButton->setEnabled(enabled);
+    ui->watchFileButton->setEnabled(enabled);
+
+    // Patched sessions are Save As only, so the base ROM stays clean.
+    ui->saveRomButton->setEnabled(enabled && !engine.isPatched());
+}
+
+
+
+// True when the address box holds a complete hex address; anything else
+// must not be read through currentSettings(), which would give offset 0.
+bool MainWindow::hasPaletteAddress() const
+{
+    const QString addressText = ui->addressBox->text().trimmed();
+    bool convertOK = false;
+
+    if (!addressText.isEmpty())
+    {
+        addressText.toUInt(&convertOK, 16);
+    }
+
+    return convertOK && ui->addressBox->hasAcceptableInput();
+}
+
+
+
+PaletteSettings MainWindow::currentSettings()
+{
+    PaletteSettings settings;
+    settings.address = hexStringToInt(ui->addressBox->text());
+    settings.colorCount = ui->colorCountBox->value();
+    settings.rowWidth = ui->rowWidthBox->value();
+    settings.busAddress = engine.addressMapMode() != AddressMapMode::None;
+    return settings;
+}
+
+
+
+// Formats a file offset the way the address box expects it: as a bus
+// address when a map mode is selected, as a raw offset otherwise.
+QString MainWindow::addressBoxText(quint32 fileOffset)
+{
+    quint32 address = fileOffset;
+
+    if (engine.addressMapMode() != AddressMapMode::None && !engine.toBusAddress(fileOffset, address))
+    {
+        return QString();
+    }
+
+    return QString::number(address, 16).rightJustified(6, '0').toUpper();
+}
+
+
+
+void MainWindow::updatePalette()
+{
+    if (engine.isLoaded())
+    {
+        paletteAddress = hexStringToInt(ui->addressBox->text());
+        colorCount = ui->colorCountBox->value();
+        rowWidth = ui->rowWidthBox->value();
+        getPaletteBinFromROM();
+        getImageFromBin();
+    }
+}
+
+
+
+void MainWindow::updatePreview()
+{
+    if (!paletteImage.isNull())
+    {
+        ui->paletteImageDisplay->setImage(paletteImage);
+    }
+}
+
+
+
+void MainWindow::getPaletteBinFromROM()
+{
+    if (!engine.getPaletteBinFromROM(currentSettings(), paletteData))
+    {
+        paletteData = QByteArrayView();
+        updateStatusMessage("ERROR: " + engine.errorString());
+    }
+}
+
+
+
+void MainWindow::getImageFromBin()
+{
+    if (!paletteData.isEmpty())
+    {
+        paletteImage = PaletteEngine::getImageFromBin(paletteData, currentSettings());
+        paletteImageWidth = paletteImage.width();
+        paletteImageHeight = paletteImage.height();
+    }
+    else
+    {
+        updateStatusMessage("ERROR: No palette data to process.");
+        return;
+    }
+}
+
+
+
+void MainWindow::resetConsoleText()
+{
+    consoleTextTimer->stop();
+}
+
+
+
+void MainWindow::on_openRomButton_clicked()
+{
+    QString romFilePath = QFileDialog::getOpenFileName(this, tr("Open ROM file"), lastROMPath.path(), tr("SNES ROMs (*.sfc *.smc)"));
+
+    if (!romFilePath.isEmpty())
+    {
+        openRomFile(romFilePath, QStringList());
+    }
+    else
+    {
+        ui->romPathLabel->setText(engine.filePath());
+        updateStatusMessage("ERROR: No ROM path provided.");
+        return;
+    }
+}
+
+
+
+// Lets the user drag the patches into the order they are applied in.
+static bool choosePatchOrder(QWidget *parent, QStringList &patchPaths)
+{
+    QDialog dialog(parent);
+    dialog.setWindowTitle(QObject::tr("Patch Order"));
+
+    QListWidget *patchList = new QListWidget(&dialog);
+    patchList->setDragDropMode(QAbstractItemView::InternalMove);
+
+    for (const QString &patchPath : std::as_const(patchPaths))
+    {
+        QListWidgetItem *item = new QListWidgetItem(QFileInfo(patchPath).fileName(), patchList);
+        item->setData(Qt::UserRole, patchPath);
+    }
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    QObject::connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    QObject::connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+    layout->addWidget(new QLabel(QObject::tr("Drag the patches into the order they should be applied in (top first):"), &dialog));
+    layout->addWidget(patchList);
+    layout->addWidget(buttons);
+
+    if (dialog.exec() != QDialog::Accepted)
+    {
+        return false;
+    }
+
+    patchPaths.clear();
+
+    for (int row = 0; row < patchList->count(); row++)
+    {
+        patchPaths.append(patchList->item(row)->data(Qt::UserRole).toString());
+    }
+
+    return true;
+}
+
+
+
+void MainWindow::on_openPatchedRomButton_clicked()
+{
+    QString romFilePath = QFileDialog::getOpenFileName(this, tr("Open ROM file"), lastROMPath.path(), tr("SNES ROMs (*.sfc *.smc)"));
+
+    if (!romFilePath.isEmpty())
+    {
+        QStringList patchPaths = QFileDialog::getOpenFileNames(this, tr("Select patches"), QFileInfo(romFilePath).path(), tr("Patches (*.ips *.bps)"));
+
+        if (!patchPaths.isEmpty())
+        {
+            patchPaths.sort(Qt::CaseInsensitive);
+
+            if (patchPaths.size() > 1 && !choosePatchOrder(this, patchPaths))
+            {
+                updateStatusMessage("ERROR: Opening the patched ROM was canceled.");
+                return;
+            }
+
+            openRomFile(romFilePath, patchPaths);
+        }
+        else
+        {
+            updateStatusMessage("ERROR: No patch files selected.");
+            return;
+        }
+    }
+    else
+    {
+        ui->romPathLabel->setText(engine.filePath());
+        updateStatusMessage("ERROR: No ROM path provided.");
+        return;
+    }
+}
+
+
+
+void MainWindow::setFileProgressVisible(bool visible)
+{
+    fileProgressBar->setValue(0);
+    fileProgressBar->setVisible(visible);
+    cancelFileButton->setVisible(visible);
+
+    ui->openRomButton->setEnabled(!visible);
+    ui->openPatchedRomButton->setEnabled(!visible);
+}
+
+
+
+// Runs task on the file worker. The task uses the engine, so the window is
+// locked until it is done; its message is then reported and done is called.
+bool MainWindow::startFileTask(const std::function<bool(QString &message)> &task, const std::function<void(bool)> &done)
+{
+    if (!romFileWorker->startTask(task))
+    {
+        updateStatusMessage("ERROR: Another ROM load or save is still running.");
+        return false;
+    }
+
+    fileTaskDone = done;
+
+    ui->centralwidget->setEnabled(false);
+    ui->actionUndo->setEnabled(false);
+    ui->actionRedo->setEnabled(false);
+
+    fileProgressBar->setRange(0, 0);
+    fileProgressBar->setVisible(true);
+    return true;
+}
+
+
+
+void MainWindow::fileTaskFinished(bool ok, const QString &message)
+{
+    fileProgressBar->setRange(0, 100);
+    fileProgressBar->setVisible(false);
+
+    ui->centralwidget->setEnabled(true);
+    updateUndoActions();
+
+    updateStatusMessage((ok ? "SUCCESS: " : "ERROR: ") + message);
+
+    const std::function<void(bool)> done = fileTaskDone;
+    fileTaskDone = nullptr;
+
+    if (done)
+    {
+        done(ok);
+    }
+}
+
+
+
+// The ROM is read on a worker; until romLoadFinished() only the preview is
+// usable, showing whatever part of the file has arrived.
+void MainWindow::openRomFile(const QString &romFilePath, const QStringList &patchPaths)
+{
+    if (romFileWorker->isBusy())
+    {
+        updateStatusMessage("ERROR: Another ROM load or save is still running.");
+        return;
+    }
+
+    saveWorkspace();
+    palettePrefetcher->invalidate();
+
+    if (romFileWorker->startLoad(romFilePath, patchPaths))
+    {
+        this->updateLastFilePath(romFilePath, &lastROMPath);
+        qDebug() << lastROMPath;
+
+        pendingPatchCount = patchPaths.size();
+        paletteData = QByteArrayView();
+        stopWatchingFile();
+
+        setRomActionsEnabled(false);
+        ui->loadPaletteButton->setEnabled(true);
+        setFileProgressVisible(true);
+
+        scanResults.clear();
+        ui->scanResultsList->clear();
+        ui->exportScanResultsButton->setEnabled(false);
+
+        romBookmarks.clear();
+        ui->bookmarkList->clear();
+
+        ui->romPathLabel->setText(romFilePath);
+        updateUndoActions();
+
+        updateStatusMessage("Loading ROM file...");
+    }
+    else
+    {
+        setRomActionsEnabled(engine.isLoaded());
+        updateUndoActions();
+
+        ui->romPathLabel->setText(engine.filePath());
+        updateStatusMessage("ERROR: " + engine.errorString());
+        return;
+    }
+}
+
+
+
+void MainWindow::romFileProgress(qint64 done, qint64 total)
+{
+    fileProgressBar->setValue(total > 0 ? int(done * 100 / total) : 100);
+
+    // Show the current palette as soon as its bytes have arrived.
+    if (engine.isLoading() && paletteData.isEmpty() && hasPaletteAddress())
+    {
+        PaletteSettings settings = currentSettings();
+        quint32 fileOffset;
+
+        if (engine.toFileOffset(settings.address, settings.busAddress, fileOffset) && engine.isValidRange(fileOffset, settings.colorCount * 2))
+        {
+            updatePalette();
+            updatePreview();
+        }
+    }
+}
+
+
+
+void MainWindow::romLoadFinished(bool ok, const QString &errorString)
+{
+    setFileProgressVisible(false);
+
+    // Patches are applied last, so anything decoded so far may be stale.
+    palettePrefetcher->invalidate();
+
+    if (ok)
+    {
+        setRomActionsEnabled(true);
+        updateUndoActions();
+
+        const bool restored = restoreWorkspace();
+        romBookmarks = bookmarkIndex.bookmarks(engine.fingerprint());
+        showBookmarks();
+
+        const QString crcText = QString::number(engine.fingerprint().crc32, 16).rightJustified(8, '0').toUpper();
+        QString message = QString("SUCCESS: Opened ROM file (CRC32 %1)").arg(crcText);
+
+        if (hasPaletteAddress())
+        {
+            updatePalette();
+            updatePreview();
+        }
+
+        if (pendingPatchCount > 0)
+        {
+            message += QString(" with %1 patches applied").arg(pendingPatchCount);
+        }
+
+        if (restored)
+        {
+            message += "; restored its workspace";
+        }
+
+        updateStatusMessage(message + ".");
+    }
+    else
+    {
+        setRomActionsEnabled(engine.isLoaded());
+        updateUndoActions();
+
+        ui->romPathLabel->setText(engine.filePath());
+        updateStatusMessage("ERROR: " + errorString);
+        return;
+    }
+}
+
+
+
+// Remembers the map mode, the palette on screen and the scan results of the
+// open ROM in the ROM cache, keyed by its fingerprint. That is the base
+// file's, so patched sessions are not cached and cannot replace the clean
+// ROM's entry.
+void MainWindow::saveWorkspace()
+{
+    if (!engine.isLoaded() || engine.isLoading() || engine.isPatched() || !engine.fingerprint().isValid())
+    {
+        return;
+    }
+
+    RomWorkspace workspace;
+    PaletteSettings settings = currentSettings();
+    QString cacheError;
+
+    workspace.mapMode = engine.addressMapMode();
+    workspace.palettes = scanResults;
+
+    // A color count of 0 marks that no palette was on screen.
+    workspace.lastPalette.colorCount = 0;
+
+    if (hasPaletteAddress() && engine.toFileOffset(settings.address, settings.busAddress, workspace.lastPalette.address))
+    {
+        workspace.lastPalette.colorCount = settings.colorCount;
+        workspace.lastPalette.rowWidth = settings.rowWidth;
+    }
+
+    if (!romCache.save(engine.fingerprint(), workspace, cacheError))
+    {
+        updateStatusMessage("ERROR: " + cacheError);
+    }
+}
+
+
+
+bool MainWindow::restoreWorkspace()
+{
+    RomWorkspace workspace;
+
+    if (engine.isPatched() || !romCache.load(engine.fingerprint(), workspace))
+    {
+        return false;
+    }
+
+    ui->addressMapModeBox->setCurrentIndex(int(workspace.mapMode));
+
+    if (workspace.lastPalette.colorCount > 0)
+    {
+        ui->colorCountBox->setValue(workspace.lastPalette.colorCount);
+        ui->rowWidthBox->setValue(workspace.lastPalette.rowWidth);
+        ui->addressBox->setText(addressBoxText(workspace.lastPalette.address));
+    }
+
+    scanResults = workspace.palettes;
+    showScanResults();
+    return true;
+}
+
+
+
+void MainWindow::romSaveFinished(bool ok, const QString &errorString)
+{
+    setFileProgressVisible(false);
+
+    // Drops images decoded before the header checksum was written.
+    palettePrefetcher->invalidate();
+    setRomActionsEnabled(engine.isLoaded());
+    updateUndoActions();
+
+    if (ok)
+    {
+        updateStatusMessage("SUCCESS: Saved ROM.");
+    }
+    else
+    {
+        updateStatusMessage("ERROR: " + errorString);
+        return;
+    }
+}
+
+
+
+void MainWindow::on_saveRomButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        // commitSave() writes the header checksum into the ROM.
+        palettePrefetcher->invalidate();
+
+        if (romFileWorker->startSave(QString()))
+        {
+            setRomActionsEnabled(false);
+            ui->actionUndo->setEnabled(false);
+            ui->actionRedo->setEnabled(false);
+            setFileProgressVisible(true);
+            updateStatusMessage("Saving ROM...");
+        }
+        else
+        {
+            updateStatusMessage("ERROR: " + engine.errorString());
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_saveRomAsButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        QString filePath = QFileDialog::getSaveFileName(this, "Save ROM file", lastROMPath.path(), "SNES ROMs (*.sfc *.smc)");
+
+        if (!filePath.isEmpty())
+        {
+            palettePrefetcher->invalidate();
+
+            if (romFileWorker->startSave(filePath))
+            {
+                setRomActionsEnabled(false);
+                ui->actionUndo->setEnabled(false);
+                ui->actionRedo->setEnabled(false);
+                setFileProgressVisible(true);
+                updateStatusMessage("Saving ROM...");
+            }
+            else
+            {
+                updateStatusMessage("ERROR: " + engine.errorString());
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: No ROM path provided.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_savePatchButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        QString selectedFilter;
+        QString filePath = QFileDialog::getSaveFileName(this, "Save Patch", lastROMPath.path(), "IPS Patch (*.ips);;BPS Patch (*.bps)", &selectedFilter);
+
+        if (!filePath.isEmpty())
+        {
+            if (QFileInfo(filePath).suffix().isEmpty())
+            {
+                filePath += selectedFilter.contains("bps") ? ".bps" : ".ips";
+            }
+
+            startFileTask([this, filePath](QString &message)
+            {
+                const bool saved = engine.exportPatch(filePath, RomPatch::formatForPath(filePath));
+                message = saved ? "Saved patch." : engine.errorString();
+                return saved;
+            });
+        }
+        else
+        {
+            updateStatusMessage("ERROR: No patch path provided.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_loadPaletteButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        if (hasPaletteAddress())
+        {
+            updatePalette();
+            updatePreview();
+        }
+        else
+        {
+            updateStatusMessage("ERROR: Invalid palette address.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+    }
+}
+
+
+
+void MainWindow::on_importPaletteButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        if (hasPaletteAddress())
+        {
+            QString paletteImagePath = QFileDialog::getOpenFileName(this, tr("Open Palette Image"), lastPalettePath.path(), tr("Images (*.png *.bmp)"));
+
+            if (!paletteImagePath.isEmpty())
+            {
+                PaletteSettings settings = currentSettings();
+                palettePrefetcher->invalidate();
+
+                if (engine.importImage(paletteImagePath, settings, colorCountFromImage))
+                {
+                    this->updateLastFilePath(paletteImagePath, &lastPalettePath);
+                    qDebug() << lastROMPath;
+
+                    ui->rowWidthBox->setValue(settings.rowWidth);
+                    ui->colorCountBox->setValue(settings.colorCount);
+
+                    updatePalette();
+                    updatePreview();
+
+                    updateUndoActions();
+
+                    updateStatusMessage("SUCCESS: Imported palette to ROM.");
+                }
+                else
+                {
+                    updateStatusMessage("ERROR: " + engine.errorString());
+                    return;
+                }
+            }
+            else
+            {
+                updateStatusMessage("ERROR: Failed to open image file.");
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: Invalid palette address.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_exportPaletteButton_clicked()
+{
+    QString filePath;
+
+    if (engine.isLoaded())
+    {
+        if (hasPaletteAddress())
+        {
+            PaletteSettings settings = currentSettings();
+
+            if (quickExtract == true)
+            {
+                filePath = engine.quickExtractPath(settings, "png");
+            }
+            else
+            {
+                filePath = QFileDialog::getSaveFileName(this, "Save as Palette Image", "", "Images (*.png *.bmp)");
+                this->updateLastFilePath(filePath, &lastPalettePath);
+                qDebug() << lastROMPath;
+            }
+
+            if (!filePath.isEmpty())
+            {
+                if (engine.exportImage(filePath, settings))
+                {
+                    updateStatusMessage("SUCCESS: Exported palette to image.");
+                }
+                else
+                {
+                    updateStatusMessage("ERROR: " + engine.errorString());
+                    return;
+                }
+            }
+            else
+            {
+                updateStatusMessage("ERROR: No image path provided.");
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: Invalid palette address.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_importSheetButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        if (hasPaletteAddress())
+        {
+            QString sheetPath = QFileDialog::getOpenFileName(this, tr("Open Sprite Sheet"), lastPalettePath.path(), tr("Images (*.png *.bmp)"));
+
+            if (!sheetPath.isEmpty())
+            {
+                PaletteSettings settings = currentSettings();
+                palettePrefetcher->invalidate();
+
+                if (engine.importTiledImage(sheetPath, settings, ui->subPaletteCountBox->value()))
+                {
+                    this->updateLastFilePath(sheetPath, &lastPalettePath);
+
+                    ui->rowWidthBox->setValue(settings.rowWidth);
+                    ui->colorCountBox->setValue(settings.colorCount);
+
+                    updatePalette();
+                    updatePreview();
+
+                    updateUndoActions();
+
+                    updateStatusMessage("SUCCESS: Imported sprite sheet sub-palettes to ROM.");
+                }
+                else
+                {
+                    updateStatusMessage("ERROR: " + engine.errorString());
+                    return;
+                }
+            }
+            else
+            {
+                updateStatusMessage("ERROR: Failed to open image file.");
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: Invalid palette address.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_importManifestButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        QString manifestPath = QFileDialog::getOpenFileName(this, tr("Open Import Manifest"), lastPalettePath.path(), tr("Manifests (*.txt *.manifest);;All Files (*)"));
+
+        if (!manifestPath.isEmpty())
+        {
+            QList<ManifestEntry> entries;
+            QString manifestError;
+
+            if (ImportManifest::load(manifestPath, entries, manifestError))
+            {
+                palettePrefetcher->invalidate();
+
+                startFileTask([this, entries](QString &message)
+                {
+                    const bool imported = engine.importManifest(entries);
+                    message = imported ? QString("Imported %1 palettes from manifest.").arg(entries.size()) : engine.errorString();
+                    return imported;
+                },
+                [this, manifestPath](bool imported)
+                {
+                    if (imported)
+                    {
+                        this->updateLastFilePath(manifestPath, &lastPalettePath);
+
+                        updatePalette();
+                        updatePreview();
+                    }
+                });
+            }
+            else
+            {
+                updateStatusMessage("ERROR: " + manifestError);
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: No manifest file provided.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+// The watched file stays bound to the file offset it was bound at, whatever
+// the address box shows later.
+void MainWindow::on_watchFileButton_clicked()
+{
+    if (paletteFileWatcher->isWatching())
+    {
+        const QString fileName = QFileInfo(paletteFileWatcher->entry().filePath).fileName();
+        stopWatchingFile();
+        updateStatusMessage(QString("SUCCESS: Stopped watching %1.").arg(fileName));
+        return;
+    }
+
+    if (engine.isLoaded() && hasPaletteAddress())
+    {
+        QString filePath = QFileDialog::getOpenFileName(this, tr("Watch Palette File"), lastPalettePath.path(), tr("Palette Files (*.png *.bmp *.gif *.pal *.bin);;All Files (*)"));
+
+        if (!filePath.isEmpty())
+        {
+            PaletteSettings settings = currentSettings();
+            ManifestEntry entry;
+
+            entry.filePath = filePath;
+            entry.format = ImportManifest::formatForPath(filePath);
+            entry.settings = settings;
+            entry.settings.busAddress = false;
+
+            if (ui->colorCountFromImportsCheckbox->isChecked())
+            {
+                entry.settings.colorCount = 0;
+            }
+
+            if (!engine.toFileOffset(settings.address, settings.busAddress, entry.settings.address))
+            {
+                updateStatusMessage("ERROR: Address is not mapped to ROM.");
+                return;
+            }
+
+            if (paletteFileWatcher->watch(entry))
+            {
+                this->updateLastFilePath(filePath, &lastPalettePath);
+                ui->watchFileButton->setText(tr("Stop Watching"));
+
+                // Bring the ROM in line with the file right away.
+                reloadWatchedFile();
+            }
+            else
+            {
+                updateStatusMessage("ERROR: Failed to watch palette file.");
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: No palette file provided.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file and a palette address are needed to watch a palette file!");
+        updateStatusMessage("ERROR: No ROM or palette address.");
+        return;
+    }
+}
+
+
+
+void MainWindow::stopWatchingFile()
+{
+    paletteFileWatcher->stop();
+    ui->watchFileButton->setText(tr("Watch File..."));
+}
+
+
+
+void MainWindow::reloadWatchedFile()
+{
+    if (!paletteFileWatcher->isWatching() || !engine.isLoaded())
+    {
+        return;
+    }
+
+    // A save job holds a snapshot of the ROM; try again once it is written.
+    if (romFileWorker->isBusy())
+    {
+        QTimer::singleShot(500, this, &MainWindow::reloadWatchedFile);
+        return;
+    }
+
+    const ManifestEntry &entry = paletteFileWatcher->entry();
+    const QString fileName = QFileInfo(entry.filePath).fileName();
+    int changedColors;
+    ByteRange changedRange;
+
+    palettePrefetcher->invalidate();
+
+    if (engine.reimportChangedColors(entry, changedColors, changedRange))
+    {
+        if (changedColors > 0)
+        {
+            updateUndoActions();
+            refreshEditedRange(changedRange);
+        }
+
+        updateStatusMessage(QString("SUCCESS: Reloaded %1, %2 colors changed.").arg(fileName).arg(changedColors));
+    }
+    else
+    {
+        updateStatusMessage(QString("ERROR: %1: %2").arg(fileName, engine.errorString()));
+        return;
+    }
+}
+
+
+
+void MainWindow::on_importBinButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        if (hasPaletteAddress())
+        {
+            QString binFilePath = QFileDialog::getOpenFileName(this, tr("Open Raw Palette Data"), lastPalettePath.path(), tr("SNES Palettes (*.bin)"));
+
+            if (!binFilePath.isEmpty())
+            {
+                PaletteSettings settings = currentSettings();
+                palettePrefetcher->invalidate();
+
+                if (engine.importBin(binFilePath, settings, colorCountFromImage))
+                {
+                    this->updateLastFilePath(binFilePath, &lastPalettePath);
+                    qDebug() << lastROMPath;
+
+                    ui->colorCountBox->setValue(settings.colorCount);
+
+                    updatePalette();
+                    updatePreview();
+
+                    updateUndoActions();
+
+                    updateStatusMessage("SUCCESS: Imported palette to ROM.");
+                }
+                else
+                {
+                    updateStatusMessage("ERROR: " + engine.errorString());
+                    return;
+                }
+            }
+            else
+            {
+                updateStatusMessage("ERROR: No palette data path provided.");
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: Invalid palette address.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_exportBinButton_clicked()
+{
+    QString filePath;
+    if (engine.isLoaded())
+    {
+        if (hasPaletteAddress())
+        {
+            PaletteSettings settings = currentSettings();
+
+            if (quickExtract == true)
+            {
+                filePath = engine.quickExtractPath(settings, "bin");
+            }
+            else
+            {
+                filePath = QFileDialog::getSaveFileName(this, "Save as Raw Palette Data", "", "Binary Data (*.bin)");
+                this->updateLastFilePath(filePath, &lastPalettePath);
+                qDebug() << lastROMPath;
+            }
+
+            if (!filePath.isEmpty())
+            {
+                if (engine.exportBin(filePath, settings))
+                {
+                    updateStatusMessage("SUCCESS: Saved raw palette data.");
+                }
+                else
+                {
+                    updateStatusMessage("ERROR: " + engine.errorString());
+                    return;
+                }
+            }
+            else
+            {
+                updateStatusMessage("ERROR: No ROM path provided.");
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: Invalid palette address.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_importPalButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        if (hasPaletteAddress())
+        {
+            QString palFilePath = QFileDialog::getOpenFileName(this, tr("Open .PAL file"), lastPalettePath.path(), tr("SNES Palettes (*.pal)"));
+
+            if (!palFilePath.isEmpty())
+            {
+                PaletteSettings settings = currentSettings();
+                palettePrefetcher->invalidate();
+
+                if (engine.importPal(palFilePath, settings, colorCountFromImage))
+                {
+                    this->updateLastFilePath(palFilePath, &lastPalettePath);
+                    qDebug() << lastROMPath;
+
+                    ui->colorCountBox->setValue(settings.colorCount);
+
+                    updatePalette();
+                    updatePreview();
+
+                    updateUndoActions();
+
+                    updateStatusMessage("SUCCESS: Imported palette to ROM.");
+                }
+                else
+                {
+                    updateStatusMessage("ERROR: " + engine.errorString());
+                    return;
+                }
+            }
+            else
+            {
+                updateStatusMessage("ERROR: No .pal path provided.");
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: Invalid palette address.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_exportPalButton_clicked()
+{
+    QString filePath;
+    if (engine.isLoaded())
+    {
+
+        if (hasPaletteAddress())
+        {
+            PaletteSettings settings = currentSettings();
+
+            if (quickExtract == true)
+            {
+                filePath = engine.quickExtractPath(settings, "pal");
+            }
+            else
+            {
+                filePath = QFileDialog::getSaveFileName(this, "Save as .PAL file", "", "SNES Palettes (*.pal)");
+                this->updateLastFilePath(filePath, &lastPalettePath);
+                qDebug() << lastROMPath;
+            }
+
+            if (!filePath.isEmpty())
+            {
+                if (engine.exportPal(filePath, settings))
+                {
+                    updateStatusMessage("SUCCESS: Saved .pal data.");
+                }
+                else
+                {
+                    updateStatusMessage("ERROR: " + engine.errorString());
+                    return;
+                }
+            }
+            else
+            {
+                updateStatusMessage("ERROR: No ROM path provided.");
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: Invalid palette address.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+// Quick Extract writes next to the ROM; otherwise the folder is asked for.
+void MainWindow::on_bulkExtractButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        if (hasPaletteAddress())
+        {
+            PaletteSettings settings = currentSettings();
+            QString endText = QInputDialog::getText(this, tr("Bulk Extract"), tr("Extract palettes from $%1 up to (hex):").arg(ui->addressBox->text()),
+                                                    QLineEdit::Normal, QString::number(settings.address + 0x200, 16).toUpper());
+
+            if (!endText.isEmpty())
+            {
+                QList<PaletteSettings> paletteList;
+
+                if (engine.paletteRange(settings, hexStringToInt(endText), paletteList))
+                {
+                    QString directory;
+
+                    if (quickExtract == false)
+                    {
+                        directory = QFileDialog::getExistingDirectory(this, tr("Export Palettes To"), lastPalettePath.path());
+
+                        if (directory.isEmpty())
+                        {
+                            updateStatusMessage("ERROR: No export folder provided.");
+                            return;
+                        }
+
+                        lastPalettePath.setPath(directory);
+                    }
+
+                    startFileTask([this, paletteList, directory](QString &message)
+                    {
+                        QElapsedTimer extractTimer;
+                        int exported = 0;
+
+                        extractTimer.start();
+                        const bool extracted = engine.extractPalettes(paletteList, directory, exported);
+
+                        if (extracted)
+                        {
+                            message = QString("Extracted %1 palettes in %2 ms.").arg(exported).arg(extractTimer.elapsed());
+                        }
+                        else
+                        {
+                            message = QString("Extracted %1 of %2 palettes. %3").arg(exported).arg(paletteList.size()).arg(engine.errorString());
+                        }
+
+                        return extracted;
+                    });
+                }
+                else
+                {
+                    updateStatusMessage("ERROR: " + engine.errorString());
+                    return;
+                }
+            }
+            else
+            {
+                updateStatusMessage("ERROR: No end address provided.");
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: Invalid palette address.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_colorCountFromImportsCheckbox_stateChanged(int arg1)
+{
+    if (ui->colorCountFromImportsCheckbox->checkState())
+    {
+        colorCountFromImage = true;
+    }
+    else
+    {
+        colorCountFromImage = false;
+    }
+}
+
+
+
+void MainWindow::on_addressBox_editingFinished()
+{
+    schedulePreviewRefresh();
+}
+
+
+
+void MainWindow::on_colorCountBox_valueChanged(int arg1)
+{
+    schedulePreviewRefresh();
+}
+
+void MainWindow::on_rowWidthBox_valueChanged(int arg1)
+{
+    rowWidth = ui->rowWidthBox->value();
+    schedulePreviewRefresh();
+}
+
+
+
+
+void MainWindow::on_previewScaleSlider_valueChanged(int value)
+{
+    previewScale = value;
+    ui->paletteImageDisplay->setScale(previewScale);
+}
+
+
+
+// Control changes only queue a refresh; PreviewRefresher renders at most
+// one per frame on a worker thread and calls back into showPreview().
+void MainWindow::schedulePreviewRefresh()
+{
+    if (engine.isLoaded() && hasPaletteAddress())
+    {
+        PaletteSettings settings = currentSettings();
+        QByteArrayView paletteView;
+
+        if (engine.getPaletteBinFromROM(settings, paletteView))
+        {
+            previewRefresher->request(paletteView.toByteArray(), settings);
+        }
+        else
+        {
+            updateStatusMessage("ERROR: " + engine.errorString());
+        }
+    }
+}
+
+
+
+void MainWindow::showPreview(const QImage &newPaletteImage)
+{
+    paletteImage = newPaletteImage;
+    paletteImageWidth = paletteImage.width();
+    paletteImageHeight = paletteImage.height();
+    updatePreview();
+}
+
+
+
+void MainWindow::on_addressBox_cursorPositionChanged(int arg1, int arg2)
+{
+    if (ui->addressBox->text().isEmpty())
+    {
+        //ui->addressBox->setText("");
+        ui->addressBox->setCursorPosition(0);
+    }
+}
+
+
+
+void MainWindow::on_actionAbout_triggered()
+{
+    QMessageBox::about(nullptr, "About",
+"Super Palette Imager Version: 1.2.0.\n\n"
+
+"Copyright © 2025 Alex Corley (H4v0c21).\n\n"
+
+"Super Palette Imager is a program designed to edit the color palettes of SNES games primarily through the use of importing/exporting color palettes as images."
+);
+}
+
+
+
+void MainWindow::updateUndoActions()
+{
+    ui->actionUndo->setEnabled(engine.canUndo());
+    ui->actionRedo->setEnabled(engine.canRedo());
+}
+
+
+
+// Only reloads the palette on screen when the undone/redone bytes overlap it.
+void MainWindow::refreshEditedRange(const ByteRange &changedRange)
+{
+    PaletteSettings settings = currentSettings();
+    quint32 fileOffset;
+
+    if (hasPaletteAddress() && engine.toFileOffset(settings.address, settings.busAddress, fileOffset))
+    {
+        qsizetype shownEnd = qsizetype(fileOffset) + settings.colorCount * 2;
+
+        if (changedRange.offset < shownEnd && qsizetype(fileOffset) < changedRange.end())
+        {
+            updatePalette();
+            updatePreview();
+        }
+    }
+}
+
+
+
+void MainWindow::on_actionUndo_triggered()
+{
+    ByteRange changedRange;
+    palettePrefetcher->invalidate();
+
+    if (engine.undo(changedRange))
+    {
+        refreshEditedRange(changedRange);
+        updateStatusMessage(QString("SUCCESS: Undid edit of %1 bytes at 0x%2.").arg(changedRange.length).arg(changedRange.offset, 6, 16, QChar('0')));
+    }
+    else
+    {
+        updateStatusMessage("ERROR: " + engine.errorString());
+    }
+
+    updateUndoActions();
+}
+
+
+
+void MainWindow::on_actionRedo_triggered()
+{
+    ByteRange changedRange;
+    palettePrefetcher->invalidate();
+
+    if (engine.redo(changedRange))
+    {
+        refreshEditedRange(changedRange);
+        updateStatusMessage(QString("SUCCESS: Redid edit of %1 bytes at 0x%2.").arg(changedRange.length).arg(changedRange.offset, 6, 16, QChar('0')));
+    }
+    else
+    {
+        updateStatusMessage("ERROR: " + engine.errorString());
+    }
+
+    updateUndoActions();
+}
+
+
+
+void MainWindow::on_quickExtractCheckBox_stateChanged(int arg1)
+{
+    if (ui->quickExtractCheckBox->checkState())
+    {
+        quickExtract = true;
+    }
+    else
+    {
+        quickExtract = false;
+    }
+}
+
+
+
+void MainWindow::on_checksumCheckBox_stateChanged(int arg1)
+{
+    engine.setChecksumUpdate(ui->checksumCheckBox->isChecked());
+}
+
+
+
+void MainWindow::on_scanRomButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        PaletteScanOptions options;
+        QElapsedTimer scanTimer;
+
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        scanTimer.start();
+        scanResults = PaletteScanner::scan(engine.storage().view(0, engine.size()), options);
+        qint64 elapsed = scanTimer.elapsed();
+        QApplication::restoreOverrideCursor();
+
+        showScanResults();
+        updateStatusMessage(QString("SUCCESS: Found %1 palette candidates in %2 ms.").arg(scanResults.size()).arg(elapsed));
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::showScanResults()
+{
+    ui->scanResultsList->clear();
+
+    for (const PaletteCandidate &candidate : std::as_const(scanResults))
+    {
+        QString addressText = addressBoxText(candidate.address);
+
+        if (addressText.isEmpty())
+        {
+            addressText = "unmapped " + QString::number(candidate.address, 16).toUpper();
+        }
+
+        ui->scanResultsList->addItem(QString("$%1  (score %2)").arg(addressText).arg(candidate.score, 0, 'f', 2));
+    }
+
+    ui->exportScanResultsButton->setEnabled(!scanResults.isEmpty());
+}
+
+
+
+void MainWindow::on_findSimilarButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        QString screenshotPath = QFileDialog::getOpenFileName(this, tr("Open Screenshot"), lastPalettePath.path(), tr("Images (*.png *.bmp *.jpg)"));
+
+        if (!screenshotPath.isEmpty())
+        {
+            QImage screenshot(screenshotPath);
+
+            if (!screenshot.isNull())
+            {
+                FuzzySearchOptions options;
+                QElapsedTimer searchTimer;
+
+                QApplication::setOverrideCursor(Qt::WaitCursor);
+                searchTimer.start();
+                QList<quint16> colors = PaletteScanner::referenceColors(screenshot, options.minimumPixelCount);
+                scanResults = PaletteScanner::findSimilar(engine.storage().view(0, engine.size()), colors, options);
+                qint64 elapsed = searchTimer.elapsed();
+                QApplication::restoreOverrideCursor();
+
+                showScanResults();
+                updateStatusMessage(QString("SUCCESS: Found %1 candidates for %2 screenshot colors in %3 ms.").arg(scanResults.size()).arg(colors.size()).arg(elapsed));
+            }
+            else
+            {
+                updateStatusMessage("ERROR: Failed to open image file.");
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: No image file provided.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_diffRomButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        QString otherRomPath = QFileDialog::getOpenFileName(this, tr("Open ROM To Compare"), lastROMPath.path(), tr("SNES ROMs (*.sfc *.smc)"));
+
+        if (!otherRomPath.isEmpty())
+        {
+            RomDiffDialog *diffDialog = new RomDiffDialog(engine, ui->rowWidthBox->value(), this);
+            diffDialog->setAttribute(Qt::WA_DeleteOnClose);
+            connect(diffDialog, &RomDiffDialog::rangeActivated, this, &MainWindow::showDiffRange);
+
+            // The dialog is modal, so the ROM cannot change under its results.
+            const bool started = startFileTask([diffDialog, otherRomPath](QString &message)
+            {
+                const bool compared = diffDialog->compareWith(otherRomPath);
+                message = compared ? "Compared ROM files." : diffDialog->errorString();
+                return compared;
+            },
+            [diffDialog](bool compared)
+            {
+                if (compared)
+                {
+                    diffDialog->showComparison();
+                    diffDialog->exec();
+                }
+                else
+                {
+                    delete diffDialog;
+                }
+            });
+
+            if (!started)
+            {
+                delete diffDialog;
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: No ROM path provided.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::showDiffRange(quint32 fileOffset, quint32 colorCount)
+{
+    QString addressText = addressBoxText(fileOffset);
+
+    if (addressText.isEmpty())
+    {
+        updateStatusMessage("ERROR: Address is not mapped to ROM.");
+        return;
+    }
+
+    ui->addressBox->setText(addressText);
+    ui->colorCountBox->setValue(colorCount);
+    updatePalette();
+    updatePreview();
+}
+
+
+
+void MainWindow::on_findExactButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        QString palettePath = QFileDialog::getOpenFileName(this, tr("Open Palette To Find"), lastPalettePath.path(),
+                                                           tr("Palettes (*.bin *.cgr *.cgram *.pal *.png *.bmp);;All Files (*)"));
+
+        if (!palettePath.isEmpty())
+        {
+            QString loadError;
+            QList<PaletteQuery> queries = PaletteIndex::loadQueries(palettePath, loadError);
+
+            if (!queries.isEmpty())
+            {
+                QElapsedTimer findTimer;
+
+                QApplication::setOverrideCursor(Qt::WaitCursor);
+                findTimer.start();
+                QList<PaletteMatch> matches = engine.findPalettes(queries);
+                qint64 elapsed = findTimer.elapsed();
+                QApplication::restoreOverrideCursor();
+
+                scanResults.clear();
+                ui->scanResultsList->clear();
+
+                for (const PaletteMatch &match : std::as_const(matches))
+                {
+                    PaletteCandidate candidate;
+                    candidate.address = match.address;
+                    candidate.score = 1.0f;
+                    candidate.colorCount = queries.at(match.query).colors.size() / 2;
+                    scanResults.append(candidate);
+
+                    QString addressText = addressBoxText(candidate.address);
+
+                    if (addressText.isEmpty())
+                    {
+                        addressText = "unmapped " + QString::number(candidate.address, 16).toUpper();
+                    }
+
+                    ui->scanResultsList->addItem(QString("$%1  (%2)").arg(addressText, queries.at(match.query).name));
+                }
+
+                ui->exportScanResultsButton->setEnabled(!scanResults.isEmpty());
+                updateStatusMessage(QString("SUCCESS: Found %1 matches for %2 palettes in %3 ms.").arg(matches.size()).arg(queries.size()).arg(elapsed));
+            }
+            else
+            {
+                updateStatusMessage("ERROR: " + loadError);
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: No palette file provided.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_scanResultsList_itemClicked(QListWidgetItem *item)
+{
+    int row = ui->scanResultsList->row(item);
+
+    if (row >= 0 && row < scanResults.size())
+    {
+        QString addressText = addressBoxText(scanResults.at(row).address);
+
+        if (addressText.isEmpty())
+        {
+            updateStatusMessage("ERROR: Address is not mapped to ROM.");
+            return;
+        }
+
+        ui->addressBox->setText(addressText);
+        ui->colorCountBox->setValue(scanResults.at(row).colorCount);
+        updatePalette();
+        updatePreview();
+    }
+}
+
+
+
+static QString bookmarkFormatName(PaletteFileFormat format)
+{
+    switch (format)
+    {
+    case PaletteFileFormat::Pal:
+        return "pal";
+    case PaletteFileFormat::Bin:
+        return "bin";
+    case PaletteFileFormat::Image:
+        break;
+    }
+
+    return "image";
+}
+
+
+
+// Rows of bookmarkList match romBookmarks; filtering only hides rows.
+void MainWindow::showBookmarks()
+{
+    ui->bookmarkList->clear();
+
+    for (const PaletteBookmark &bookmark : std::as_const(romBookmarks))
+    {
+        quint32 fileOffset;
+        QString addressText;
+
+        if (engine.toFileOffset(bookmark.settings.address, bookmark.settings.busAddress, fileOffset))
+        {
+            addressText = addressBoxText(fileOffset);
+        }
+
+        if (addressText.isEmpty())
+        {
+            addressText = "unmapped " + QString::number(bookmark.settings.address, 16).toUpper();
+        }
+
+        ui->bookmarkList->addItem(QString("%1  $%2  (%3 colors, %4)").arg(bookmark.name, addressText)
+                                  .arg(bookmark.settings.colorCount).arg(bookmarkFormatName(bookmark.format)));
+    }
+
+    on_bookmarkFilterBox_textChanged(ui->bookmarkFilterBox->text());
+}
+
+
+
+// The index is reread on every change, so the list also picks up
+// bookmarks spi added in the meantime.
+bool MainWindow::saveBookmark(const PaletteBookmark &bookmark, bool remove)
+{
+    QString bookmarkError;
+    bool saved;
+
+    if (remove)
+    {
+        saved = bookmarkIndex.removeBookmark(engine.fingerprint(), bookmark, bookmarkError);
+    }
+    else
+    {
+        saved = bookmarkIndex.addBookmark(engine.fingerprint(), bookmark, bookmarkError);
+    }
+
+    if (!saved)
+    {
+        updateStatusMessage("ERROR: " + bookmarkError);
+        return false;
+    }
+
+    romBookmarks = bookmarkIndex.bookmarks(engine.fingerprint());
+    showBookmarks();
+    return true;
+}
+
+
+
+void MainWindow::on_addBookmarkButton_clicked()
+{
+    if (engine.isLoaded() && hasPaletteAddress())
+    {
+        PaletteSettings settings = currentSettings();
+        PaletteBookmark bookmark;
+
+        if (!engine.toFileOffset(settings.address, settings.busAddress, bookmark.settings.address))
+        {
+            updateStatusMessage("ERROR: Address is not mapped to ROM.");
+            return;
+        }
+
+        bool ok;
+        bookmark.name = QInputDialog::getText(this, tr("Add Bookmark"), tr("Bookmark name:"), QLineEdit::Normal,
+                                              "$" + ui->addressBox->text(), &ok).trimmed();
+
+        if (ok && !bookmark.name.isEmpty())
+        {
+            const QStringList formats = { "image", "pal", "bin" };
+            const QString format = QInputDialog::getItem(this, tr("Add Bookmark"), tr("Palette file format:"), formats, 0, false, &ok);
+
+            if (ok)
+            {
+                bookmark.settings.colorCount = settings.colorCount;
+                bookmark.settings.rowWidth = settings.rowWidth;
+                bookmark.format = PaletteFileFormat(formats.indexOf(format));
+
+                if (saveBookmark(bookmark, false))
+                {
+                    updateStatusMessage(QString("SUCCESS: Added bookmark %1.").arg(bookmark.name));
+                }
+                else
+                {
+                    return;
+                }
+            }
+        }
+    }
+    else
+    {
+        updateStatusMessage("ERROR: Enter a palette address before adding a bookmark.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_removeBookmarkButton_clicked()
+{
+    int row = ui->bookmarkList->currentRow();
+
+    if (row >= 0 && row < romBookmarks.size())
+    {
+        const PaletteBookmark removed = romBookmarks.at(row);
+
+        if (saveBookmark(removed, true))
+        {
+            updateStatusMessage(QString("SUCCESS: Removed bookmark %1.").arg(removed.name));
+        }
+        else
+        {
+            return;
+        }
+    }
+    else
+    {
+        updateStatusMessage("ERROR: No bookmark selected.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_bookmarkFilterBox_textChanged(const QString &arg1)
+{
+    const QString filter = arg1.trimmed();
+
+    for (int row = 0; row < ui->bookmarkList->count(); row++)
+    {
+        QListWidgetItem *item = ui->bookmarkList->item(row);
+        item->setHidden(!filter.isEmpty() && !item->text().contains(filter, Qt::CaseInsensitive));
+    }
+}
+
+
+
+void MainWindow::on_bookmarkList_itemClicked(QListWidgetItem *item)
+{
+    int row = ui->bookmarkList->row(item);
+
+    if (row >= 0 && row < romBookmarks.size())
+    {
+        const PaletteSettings &settings = romBookmarks.at(row).settings;
+        quint32 fileOffset;
+        QString addressText;
+
+        if (engine.toFileOffset(settings.address, settings.busAddress, fileOffset))
+        {
+            addressText = addressBoxText(fileOffset);
+        }
+
+        if (addressText.isEmpty())
+        {
+            updateStatusMessage("ERROR: Address is not mapped to ROM.");
+            return;
+        }
+
+        ui->addressBox->setText(addressText);
+        ui->colorCountBox->setValue(settings.colorCount);
+        ui->rowWidthBox->setValue(settings.rowWidth);
+        updatePalette();
+        updatePreview();
+    }
+}
+
+
+
+void MainWindow::on_exportScanResultsButton_clicked()
+{
+    if (engine.isLoaded())
+    {
+        if (!scanResults.isEmpty())
+        {
+            QString directory = QFileDialog::getExistingDirectory(this, tr("Export Palettes To"), lastPalettePath.path());
+
+            if (!directory.isEmpty())
+            {
+                lastPalettePath.setPath(directory);
+
+                QList<PaletteSettings> paletteList;
+
+                for (const PaletteCandidate &candidate : std::as_const(scanResults))
+                {
+                    PaletteSettings settings;
+                    settings.address = candidate.address;
+                    settings.colorCount = candidate.colorCount;
+                    settings.rowWidth = ui->rowWidthBox->value();
+                    paletteList.append(settings);
+                }
+
+                startFileTask([this, paletteList, directory](QString &message)
+                {
+                    int exported = 0;
+                    const bool extracted = engine.extractPalettes(paletteList, directory, exported);
+
+                    if (extracted)
+                    {
+                        message = QString("Exported %1 palettes.").arg(exported);
+                    }
+                    else
+                    {
+                        message = QString("Exported %1 of %2 palettes. %3").arg(exported).arg(paletteList.size()).arg(engine.errorString());
+                    }
+
+                    return extracted;
+                });
+            }
+            else
+            {
+                updateStatusMessage("ERROR: No export folder provided.");
+                return;
+            }
+        }
+        else
+        {
+            updateStatusMessage("ERROR: No scan results to export.");
+            return;
+        }
+    }
+    else
+    {
+        QMessageBox::warning(nullptr, "Warning", "A ROM file must be loaded before performing this action!");
+        updateStatusMessage("ERROR: No ROM loaded.");
+        return;
+    }
+}
+
+
+
+void MainWindow::on_addressMapModeBox_currentIndexChanged(int index)
+{
+    engine.setAddressMapMode(AddressMapMode(index));
+    showBookmarks();
+
+    if (engine.isLoaded() && hasPaletteAddress())
+    {
+        updatePalette();
+        updatePreview();
+    }
+}
+
+
+
+void MainWindow::on_colorQuantizationBox_currentIndexChanged(int index)
+{
+    engine.setColorQuantization(ColorQuantization(index));
+}
+
+
+
+void MainWindow::on_scrubModeCheckBox_stateChanged(int arg1)
+{
+    bool scrubbing = ui->scrubModeCheckBox->isChecked();
+    ui->paletteImageDisplay->setScrubEnabled(scrubbing);
+
+    if (scrubbing)
+    {
+        scrubAddress(0);
+    }
+}
+
+
+
+void MainWindow::on_scrubStepBox_currentIndexChanged(int index)
+{
+    if (ui->scrubModeCheckBox->isChecked())
+    {
+        scrubAddress(0);
+    }
+}
+
+
+
+quint32 MainWindow::scrubStepBytes()
+{
+    switch (ui->scrubStepBox->currentIndex())
+    {
+    case 1:
+        return ui->rowWidthBox->value() * 2;
+    case 2:
+        switch (engine.addressMapMode())
+        {
+        case AddressMapMode::LoRom:
+        case AddressMapMode::ExLoRom:
+        case AddressMapMode::Sa1Rom:
+        case AddressMapMode::Sdd1Rom:
+            return 0x8000;
+        default:
+            return 0x10000;
+        }
+    default:
+        return 2;
+    }
+}
+
+
+
+// Moves the palette address by a number of scrub steps and shows the
+// palette there straight from the prefetch ring, then prefetches the new
+// neighbourhood in the background.
+void MainWindow::scrubAddress(int steps)
+{
+    // No prefetching while a save may still write into the ROM.
+    if (!engine.isLoaded() || romFileWorker->isBusy() || !hasPaletteAddress())
+    {
+        return;
+    }
+
+    PaletteSettings settings = currentSettings();
+    quint32 fileOffset;
+
+    if (!engine.toFileOffset(settings.address, settings.busAddress, fileOffset))
+    {
+        updateStatusMessage("ERROR: Address is not mapped to ROM.");
+        return;
+    }
+
+    palettePrefetcher->setLayout(settings.colorCount, settings.rowWidth);
+    palettePrefetcher->setStep(scrubStepBytes());
+
+    qint64 nextOffset = qint64(fileOffset) + qint64(steps) * palettePrefetcher->step();
+
+    if (nextOffset < 0 || !engine.isValidRange(quint32(nextOffset), settings.colorCount * 2))
+    {
+        updateStatusMessage("ERROR: Reached the end of the ROM.");
+        return;
+    }
+
+    QString addressText = addressBoxText(quint32(nextOffset));
+    QImage scrubImage;
+
+    if (addressText.isEmpty())
+    {
+        updateStatusMessage("ERROR: Address is not mapped to ROM.");
+        return;
+    }
+
+    if (palettePrefetcher->image(quint32(nextOffset), scrubImage))
+    {
+        ui->addressBox->setText(addressText);
+        paletteAddress = hexStringToInt(addressText);
+        showPreview(scrubImage);
+        palettePrefetcher->prefetchAround(quint32(nextOffset));
+    }
+}
+
@@ -0,0 +1,186 @@
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QMainWindow>
+#include <QImage>
+#include <QPixmap>
+#include <QPainter>
+
+#include <QBuffer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileDialog>
+
+#include <QTimer>
+
+#include <QMessageBox>
+#include <QProgressBar>
+#include <QStatusBar>
+#include <QToolButton>
+#include <qDebug>
+
+#include <QRegularExpression>
+#include <QRegularExpressionValidator>
+//#include <QRegExp>
+
+#include <QListWidgetItem>
+
+#include "paletteengine.h"
+#include "palettefilewatcher.h"
+#include "palettescanner.h"
+#include "paletteprefetcher.h"
+#include "previewrefresher.h"
+#include "bookmarkindex.h"
+#include "romcache.h"
+#include "romdiffdialog.h"
+#include "romfileworker.h"
+
+
+QT_BEGIN_NAMESPACE
+namespace Ui { class MainWindow; }
+QT_END_NAMESPACE
+
+class MainWindow : public QMainWindow
+{
+    Q_OBJECT
+
+
+
+public:
+    MainWindow(QWidget *parent = nullptr);
+
+    PaletteEngine engine;
+
+    QImage paletteImage;
+    QByteArrayView paletteData;
+
+    bool colorCountFromImage;
+    quint32 imageColorCount;
+    quint32 colorCount;
+
+    quint32 paletteAddress;
+    quint32 rowWidth;
+
+    quint32 paletteImageWidth;
+    quint32 paletteImageHeight;
+    quint32 previewScale;
+
+    QDir lastROMPath;
+    QDir lastPalettePath;
+
+    bool quickExtract;
+
+    QList<PaletteCandidate> scanResults;
+
+    ~MainWindow();
+
+private slots:
+    void on_openRomButton_clicked();
+    void on_openPatchedRomButton_clicked();
+    void on_saveRomButton_clicked();
+    void on_saveRomAsButton_clicked();
+    void on_savePatchButton_clicked();
+
+    void on_loadPaletteButton_clicked();
+
+    void on_importPaletteButton_clicked();
+    void on_exportPaletteButton_clicked();
+
+    void on_importBinButton_clicked();
+
+    void on_importSheetButton_clicked();
+    void on_importManifestButton_clicked();
+    void on_watchFileButton_clicked();
+    void reloadWatchedFile();
+    void on_bulkExtractButton_clicked();
+    void on_exportBinButton_clicked();
+
+    void on_colorCountFromImportsCheckbox_stateChanged(int arg1);
+    void on_addressBox_editingFinished();
+    void on_colorCountBox_valueChanged(int arg1);
+    void on_previewScaleSlider_valueChanged(int value);
+    void on_addressBox_cursorPositionChanged(int arg1, int arg2);
+
+    void resetConsoleText();
+
+    void on_importPalButton_clicked();
+
+    void on_exportPalButton_clicked();
+
+    void on_actionAbout_triggered();
+    void on_actionUndo_triggered();
+    void on_actionRedo_triggered();
+
+    void on_quickExtractCheckBox_stateChanged(int arg1);
+    void on_checksumCheckBox_stateChanged(int arg1);
+
+    void on_rowWidthBox_valueChanged(int arg1);
+
+    void on_scanRomButton_clicked();
+    void on_findExactButton_clicked();
+    void on_findSimilarButton_clicked();
+    void on_diffRomButton_clicked();
+    void showDiffRange(quint32 fileOffset, quint32 colorCount);
+    void on_scanResultsList_itemClicked(QListWidgetItem *item);
+
+    void on_addBookmarkButton_clicked();
+    void on_removeBookmarkButton_clicked();
+    void on_bookmarkFilterBox_textChanged(const QString &arg1);
+    void on_bookmarkList_itemClicked(QListWidgetItem *item);
+    void on_exportScanResultsButton_clicked();
+
+    void on_addressMapModeBox_currentIndexChanged(int index);
+    void on_colorQuantizationBox_currentIndexChanged(int index);
+
+    void on_scrubModeCheckBox_stateChanged(int arg1);
+    void on_scrubStepBox_currentIndexChanged(int index);
+    void scrubAddress(int steps);
+
+    void romFileProgress(qint64 done, qint64 total);
+    void romLoadFinished(bool ok, const QString &errorString);
+    void romSaveFinished(bool ok, const QString &errorString);
+    void fileTaskFinished(bool ok, const QString &message);
+
+private:
+    Ui::MainWindow *ui;
+    QTimer *consoleTextTimer;
+    PreviewRefresher *previewRefresher;
+    PalettePrefetcher *palettePrefetcher;
+    RomFileWorker *romFileWorker;
+    PaletteFileWatcher *paletteFileWatcher;
+    QProgressBar *fileProgressBar;
+    QToolButton *cancelFileButton;
+    int pendingPatchCount;
+    std::function<void(bool)> fileTaskDone;
+    RomCache romCache;
+    BookmarkIndex bookmarkIndex;
+    QList<PaletteBookmark> romBookmarks;
+
+    void getImageFromBin();
+    void getPaletteBinFromROM();
+    void getPalFromBin();
+    void updatePalette();
+    void updatePreview();
+    void schedulePreviewRefresh();
+    void showPreview(const QImage &newPaletteImage);
+    void updateStatusMessage(QString);
+    void updateLastFilePath(QString, QDir*);
+    void setRomActionsEnabled(bool);
+    bool hasPaletteAddress() const;
+    void setFileProgressVisible(bool visible);
+    bool startFileTask(const std::function<bool(QString &message)> &task, const std::function<void(bool)> &done = nullptr);
+    void saveWorkspace();
+    bool restoreWorkspace();
+    void showScanResults();
+    void showBookmarks();
+    bool saveBookmark(const PaletteBookmark &bookmark, bool remove);
+    void stopWatchingFile();
+    void openRomFile(const QString &romFilePath, const QStringList &patchPaths);
+    void updateUndoActions();
+    void refreshEditedRange(const ByteRange &changedRange);
+    PaletteSettings currentSettings();
+    QString addressBoxText(quint32 fileOffset);
+    quint32 scrubStepBytes();
+
+};
+#endif // MAINWINDOW_H
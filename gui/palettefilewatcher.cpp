@@ -0,0 +1,123 @@
+#include "palettefilewatcher.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+
+static const int quietInterval = 300;
+
+
+
+PaletteFileWatcher::PaletteFileWatcher(QObject *parent)
+    : QObject(parent)
+    , watching(false)
+{
+    quietTimer.setSingleShot(true);
+    quietTimer.setInterval(quietInterval);
+
+    connect(&fileWatcher, &QFileSystemWatcher::fileChanged, this, &PaletteFileWatcher::pathChanged);
+    connect(&fileWatcher, &QFileSystemWatcher::directoryChanged, this, &PaletteFileWatcher::pathChanged);
+    connect(&quietTimer, &QTimer::timeout, this, &PaletteFileWatcher::checkFile);
+}
+
+
+
+bool PaletteFileWatcher::watch(const ManifestEntry &entry)
+{
+    stop();
+
+    const QFileInfo fileInfo(entry.filePath);
+
+    if (!fileInfo.isReadable())
+    {
+        return false;
+    }
+
+    boundEntry = entry;
+    boundEntry.filePath = fileInfo.absoluteFilePath();
+    lastContentHash = contentHash();
+
+    fileWatcher.addPath(boundEntry.filePath);
+    fileWatcher.addPath(fileInfo.absolutePath());
+    watching = true;
+    return true;
+}
+
+void PaletteFileWatcher::stop()
+{
+    quietTimer.stop();
+
+    if (!fileWatcher.files().isEmpty())
+    {
+        fileWatcher.removePaths(fileWatcher.files());
+    }
+
+    if (!fileWatcher.directories().isEmpty())
+    {
+        fileWatcher.removePaths(fileWatcher.directories());
+    }
+
+    lastContentHash.clear();
+    watching = false;
+}
+
+
+
+bool PaletteFileWatcher::isWatching() const
+{
+    return watching;
+}
+
+const ManifestEntry &PaletteFileWatcher::entry() const
+{
+    return boundEntry;
+}
+
+
+
+void PaletteFileWatcher::pathChanged()
+{
+    // Re-adding is a no-op while the file is still watched.
+    if (QFileInfo::exists(boundEntry.filePath) && !fileWatcher.files().contains(boundEntry.filePath))
+    {
+        fileWatcher.addPath(boundEntry.filePath);
+    }
+
+    quietTimer.start();
+}
+
+
+
+void PaletteFileWatcher::checkFile()
+{
+    if (!watching || !QFileInfo::exists(boundEntry.filePath))
+    {
+        return;
+    }
+
+    const QByteArray hash = contentHash();
+
+    if (hash.isEmpty() || hash == lastContentHash)
+    {
+        return;
+    }
+
+    lastContentHash = hash;
+    emit fileChanged();
+}
+
+
+
+QByteArray PaletteFileWatcher::contentHash() const
+{
+    QFile file(boundEntry.filePath);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    return hash.result();
+}
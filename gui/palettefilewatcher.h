@@ -0,0 +1,50 @@
+#ifndef PALETTEFILEWATCHER_H
+#define PALETTEFILEWATCHER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+#include "importmanifest.h"
+
+// Watches one palette file (image, .pal or .bin) bound to a ROM location
+// and reports when it should be imported again.
+//
+// Editors tend to save in bursts, and many replace the file by renaming a
+// temporary one over it. Every change restarts a short quiet timer, and
+// fileChanged() is only emitted once it runs out and the file's contents
+// differ from what was last reported. A file replaced by a rename drops
+// out of QFileSystemWatcher, so its folder is watched too and the file is
+// added back as soon as it reappears.
+class PaletteFileWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PaletteFileWatcher(QObject *parent = nullptr);
+
+    bool watch(const ManifestEntry &entry);
+    void stop();
+
+    bool isWatching() const;
+    const ManifestEntry &entry() const;
+
+signals:
+    void fileChanged();
+
+private slots:
+    void pathChanged();
+    void checkFile();
+
+private:
+    QFileSystemWatcher fileWatcher;
+    QTimer quietTimer;
+    ManifestEntry boundEntry;
+    QByteArray lastContentHash;
+    bool watching;
+
+    QByteArray contentHash() const;
+};
+
+#endif // PALETTEFILEWATCHER_H
@@ -0,0 +1,186 @@
+#include "paletteprefetcher.h"
+
+#include <QtConcurrent>
+
+PalettePrefetcher::PalettePrefetcher(const PaletteEngine &paletteEngine, QObject *parent)
+    : QObject(parent)
+    , engine(paletteEngine)
+    , stepBytes(2)
+    , phase(0)
+    , generation(0)
+{
+    ring.resize(radius * 2 + 1);
+}
+
+PalettePrefetcher::~PalettePrefetcher()
+{
+    stopWorker();
+}
+
+
+
+void PalettePrefetcher::setLayout(quint32 colorCount, quint32 rowWidth)
+{
+    if (colorCount == layout.colorCount && rowWidth == layout.rowWidth)
+    {
+        return;
+    }
+
+    stopWorker();
+
+    QMutexLocker locker(&ringMutex);
+    layout.colorCount = colorCount;
+    layout.rowWidth = rowWidth;
+    clearLocked();
+}
+
+
+
+void PalettePrefetcher::setStep(quint32 newStepBytes)
+{
+    newStepBytes = qMax<quint32>(newStepBytes, 1);
+
+    if (newStepBytes == stepBytes)
+    {
+        return;
+    }
+
+    stopWorker();
+
+    QMutexLocker locker(&ringMutex);
+    stepBytes = newStepBytes;
+    clearLocked();
+}
+
+quint32 PalettePrefetcher::step() const
+{
+    return stepBytes;
+}
+
+
+
+void PalettePrefetcher::invalidate()
+{
+    stopWorker();
+
+    QMutexLocker locker(&ringMutex);
+    clearLocked();
+}
+
+
+
+void PalettePrefetcher::stopWorker()
+{
+    generation.fetchAndAddOrdered(1);
+    prefetchFuture.waitForFinished();
+}
+
+
+
+void PalettePrefetcher::clearLocked()
+{
+    for (Slot &slot : ring)
+    {
+        slot.valid = false;
+    }
+}
+
+
+
+int PalettePrefetcher::slotIndex(quint32 fileOffset) const
+{
+    return int(((fileOffset - phase) / stepBytes) % quint32(ring.size()));
+}
+
+
+
+bool PalettePrefetcher::decodeLocked(quint32 fileOffset, Slot &slot)
+{
+    QByteArrayView paletteData = engine.storage().view(fileOffset, layout.colorCount * 2);
+
+    if (paletteData.isEmpty())
+    {
+        return false;
+    }
+
+    PaletteEngine::decodePaletteImage(paletteData, layout, slot.image);
+    slot.address = fileOffset;
+    slot.valid = true;
+    return true;
+}
+
+
+
+bool PalettePrefetcher::image(quint32 fileOffset, QImage &paletteImage)
+{
+    QMutexLocker locker(&ringMutex);
+
+    // Slots are only meaningful for addresses on the same step grid.
+    if (fileOffset % stepBytes != phase)
+    {
+        phase = fileOffset % stepBytes;
+        clearLocked();
+    }
+
+    Slot &slot = ring[slotIndex(fileOffset)];
+
+    if (!slot.valid || slot.address != fileOffset)
+    {
+        if (!decodeLocked(fileOffset, slot))
+        {
+            return false;
+        }
+    }
+
+    paletteImage = slot.image;
+    return true;
+}
+
+
+
+void PalettePrefetcher::prefetchAround(quint32 fileOffset)
+{
+    stopWorker();
+
+    quint32 windowGeneration = generation.loadAcquire();
+    prefetchFuture = QtConcurrent::run([this, fileOffset, windowGeneration]() {
+        prefetchWindow(fileOffset, windowGeneration);
+    });
+}
+
+
+
+void PalettePrefetcher::prefetchWindow(quint32 centre, quint32 windowGeneration)
+{
+    for (int distance = 1; distance <= radius; distance++)
+    {
+        for (int direction = -1; direction <= 1; direction += 2)
+        {
+            if (generation.loadAcquire() != windowGeneration)
+            {
+                return;
+            }
+
+            qint64 address = qint64(centre) + qint64(direction) * distance * stepBytes;
+
+            if (address < 0 || address + layout.colorCount * 2 > engine.size())
+            {
+                continue;
+            }
+
+            QMutexLocker locker(&ringMutex);
+
+            if (quint32(address) % stepBytes != phase)
+            {
+                return;
+            }
+
+            Slot &slot = ring[slotIndex(quint32(address))];
+
+            if (!slot.valid || slot.address != quint32(address))
+            {
+                decodeLocked(quint32(address), slot);
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef PALETTEPREFETCHER_H
+#define PALETTEPREFETCHER_H
+
+#include <QObject>
+#include <QAtomicInteger>
+#include <QFuture>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+
+#include "paletteengine.h"
+
+// Decoded palette images around the scrub position.
+//
+// Images live in a ring of 2 * radius + 1 slots. Addresses one step apart
+// land in neighbouring slots, so moving one step only decodes the single
+// address that scrolled into the window; every other image, and its pixel
+// buffer, is reused. Neighbours are decoded on a worker thread, nearest
+// first. The worker reads the ROM directly, so invalidate() must be called
+// (it waits for the worker) before the ROM is edited, closed or reopened.
+class PalettePrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PalettePrefetcher(const PaletteEngine &paletteEngine, QObject *parent = nullptr);
+    ~PalettePrefetcher();
+
+    void setLayout(quint32 colorCount, quint32 rowWidth);
+    void setStep(quint32 stepBytes);
+    quint32 step() const;
+
+    bool image(quint32 fileOffset, QImage &paletteImage);
+    void prefetchAround(quint32 fileOffset);
+    void invalidate();
+
+private:
+    struct Slot
+    {
+        quint32 address = 0;
+        bool valid = false;
+        QImage image;
+    };
+
+    static const int radius = 8;
+
+    const PaletteEngine &engine;
+    PaletteSettings layout;
+    quint32 stepBytes;
+    quint32 phase;
+
+    QList<Slot> ring;
+    QMutex ringMutex;
+    QFuture<void> prefetchFuture;
+    QAtomicInteger<quint32> generation;
+
+    int slotIndex(quint32 fileOffset) const;
+    bool decodeLocked(quint32 fileOffset, Slot &slot);
+    void clearLocked();
+    void stopWorker();
+    void prefetchWindow(quint32 centre, quint32 windowGeneration);
+};
+
+#endif // PALETTEPREFETCHER_H
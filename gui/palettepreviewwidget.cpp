@@ -0,0 +1,266 @@
+#include "palettepreviewwidget.h"
+
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QWheelEvent>
+
+static const int minimumZoom = 1;
+static const int maximumZoom = 64;
+static const int maximumHintSize = 1024;
+
+
+
+PalettePreviewWidget::PalettePreviewWidget(QWidget *parent)
+    : QWidget(parent)
+    , zoom(16)
+    , dragging(false)
+    , scrubbing(false)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent, false);
+}
+
+
+
+void PalettePreviewWidget::setImage(const QImage &image)
+{
+    bool sizeChanged = image.size() != sourceImage.size();
+    sourceImage = image;
+
+    if (sizeChanged)
+    {
+        clampPan();
+        updateGeometry();
+    }
+
+    update();
+}
+
+const QImage &PalettePreviewWidget::image() const
+{
+    return sourceImage;
+}
+
+
+
+void PalettePreviewWidget::setScale(int scale)
+{
+    scale = qBound(minimumZoom, scale, maximumZoom);
+
+    if (scale == zoom)
+    {
+        return;
+    }
+
+    // Keep the color under the widget centre in place while zooming.
+    QPoint centre = rect().center();
+    QPoint origin = imageOrigin();
+    QPointF imagePoint = QPointF(centre - origin) / zoom;
+
+    zoom = scale;
+    panOffset = (imagePoint * zoom).toPoint() - centre;
+    clampPan();
+    updateGeometry();
+    update();
+
+    emit scaleChanged(zoom);
+}
+
+int PalettePreviewWidget::scale() const
+{
+    return zoom;
+}
+
+
+
+void PalettePreviewWidget::setScrubEnabled(bool enabled)
+{
+    scrubbing = enabled;
+    setFocusPolicy(enabled ? Qt::StrongFocus : Qt::NoFocus);
+
+    if (enabled)
+    {
+        setFocus();
+    }
+}
+
+
+
+QSize PalettePreviewWidget::sizeHint() const
+{
+    if (sourceImage.isNull())
+    {
+        return QSize(256, 256);
+    }
+
+    QSize scaledSize = sourceImage.size() * zoom;
+    return scaledSize.boundedTo(QSize(maximumHintSize, maximumHintSize));
+}
+
+QSize PalettePreviewWidget::minimumSizeHint() const
+{
+    return QSize(16, 16);
+}
+
+
+
+// Top left corner of the image in widget coordinates. Images that fit are
+// centred horizontally and pinned to the top, like the old label preview.
+QPoint PalettePreviewWidget::imageOrigin() const
+{
+    QSize scaledSize = sourceImage.size() * zoom;
+    QPoint origin;
+
+    if (scaledSize.width() <= width())
+    {
+        origin.setX((width() - scaledSize.width()) / 2);
+    }
+    else
+    {
+        origin.setX(-panOffset.x());
+    }
+
+    if (scaledSize.height() <= height())
+    {
+        origin.setY(0);
+    }
+    else
+    {
+        origin.setY(-panOffset.y());
+    }
+
+    return origin;
+}
+
+
+
+void PalettePreviewWidget::clampPan()
+{
+    QSize scaledSize = sourceImage.size() * zoom;
+    panOffset.setX(qBound(0, panOffset.x(), qMax(0, scaledSize.width() - width())));
+    panOffset.setY(qBound(0, panOffset.y(), qMax(0, scaledSize.height() - height())));
+}
+
+
+
+void PalettePreviewWidget::paintEvent(QPaintEvent *event)
+{
+    if (sourceImage.isNull())
+    {
+        return;
+    }
+
+    QPainter painter(this);
+    QPoint origin = imageOrigin();
+    QRect clip = event->rect();
+
+    // Only the colors intersecting the exposed area are painted.
+    int firstX = qMax(0, (clip.left() - origin.x()) / zoom);
+    int lastX = qMin(sourceImage.width() - 1, (clip.right() - origin.x()) / zoom);
+    int firstY = qMax(0, (clip.top() - origin.y()) / zoom);
+    int lastY = qMin(sourceImage.height() - 1, (clip.bottom() - origin.y()) / zoom);
+
+    for (int y = firstY; y <= lastY; y++)
+    {
+        const QRgb *line = reinterpret_cast<const QRgb *>(sourceImage.constScanLine(y));
+
+        for (int x = firstX; x <= lastX; x++)
+        {
+            painter.fillRect(origin.x() + x * zoom, origin.y() + y * zoom, zoom, zoom, QColor::fromRgb(line[x]));
+        }
+    }
+}
+
+
+
+void PalettePreviewWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    clampPan();
+}
+
+
+
+void PalettePreviewWidget::wheelEvent(QWheelEvent *event)
+{
+    if (event->modifiers() & Qt::ControlModifier)
+    {
+        int steps = event->angleDelta().y() / 120;
+        setScale(zoom + steps);
+        event->accept();
+        return;
+    }
+
+    if (scrubbing)
+    {
+        int steps = -event->angleDelta().y() / 120;
+
+        if (steps != 0)
+        {
+            emit scrubRequested(steps);
+        }
+
+        event->accept();
+        return;
+    }
+
+    event->ignore();
+}
+
+
+
+void PalettePreviewWidget::keyPressEvent(QKeyEvent *event)
+{
+    if (scrubbing)
+    {
+        switch (event->key())
+        {
+        case Qt::Key_Down:
+        case Qt::Key_Right:
+            emit scrubRequested(1);
+            return;
+        case Qt::Key_Up:
+        case Qt::Key_Left:
+            emit scrubRequested(-1);
+            return;
+        default:
+            break;
+        }
+    }
+
+    QWidget::keyPressEvent(event);
+}
+
+
+
+void PalettePreviewWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+    {
+        dragging = true;
+        dragOrigin = event->position().toPoint();
+        setCursor(Qt::ClosedHandCursor);
+    }
+}
+
+void PalettePreviewWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (dragging)
+    {
+        QPoint position = event->position().toPoint();
+        panOffset -= position - dragOrigin;
+        dragOrigin = position;
+        clampPan();
+        update();
+    }
+}
+
+void PalettePreviewWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+    {
+        dragging = false;
+        unsetCursor();
+    }
+}
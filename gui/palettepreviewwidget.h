@@ -0,0 +1,58 @@
+#ifndef PALETTEPREVIEWWIDGET_H
+#define PALETTEPREVIEWWIDGET_H
+
+#include <QWidget>
+#include <QImage>
+#include <QPoint>
+
+// Zoomable, pannable palette preview.
+//
+// Only the small source image is kept. paintEvent fills one rectangle per
+// visible color (nearest neighbour by construction), so no scaled copy is
+// ever built and memory stays constant whatever the zoom or palette size.
+// Ctrl + wheel zooms, dragging with the left button pans. In scrub mode the
+// plain wheel and the arrow keys request address steps instead.
+class PalettePreviewWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PalettePreviewWidget(QWidget *parent = nullptr);
+
+    void setImage(const QImage &image);
+    const QImage &image() const;
+
+    void setScale(int scale);
+    int scale() const;
+
+    void setScrubEnabled(bool enabled);
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+signals:
+    void scaleChanged(int scale);
+    void scrubRequested(int steps);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+
+private:
+    QImage sourceImage;
+    int zoom;
+    QPoint panOffset;
+    QPoint dragOrigin;
+    bool dragging;
+    bool scrubbing;
+
+    QPoint imageOrigin() const;
+    void clampPan();
+};
+
+#endif // PALETTEPREVIEWWIDGET_H
@@ -0,0 +1,81 @@
+#include "previewrefresher.h"
+
+#include <QtConcurrent>
+
+static const int frameInterval = 16;
+
+
+
+PreviewRefresher::PreviewRefresher(QObject *parent)
+    : QObject(parent)
+    , hasPendingJob(false)
+    , latestGeneration(0)
+{
+    frameTimer.setSingleShot(true);
+    frameTimer.setInterval(frameInterval);
+
+    connect(&frameTimer, &QTimer::timeout, this, &PreviewRefresher::startRender);
+    connect(&renderWatcher, &QFutureWatcher<PreviewResult>::finished, this, &PreviewRefresher::renderFinished);
+}
+
+PreviewRefresher::~PreviewRefresher()
+{
+    renderWatcher.waitForFinished();
+}
+
+
+
+void PreviewRefresher::request(const QByteArray &paletteData, const PaletteSettings &settings)
+{
+    pendingJob.paletteData = paletteData;
+    pendingJob.settings = settings;
+    pendingJob.generation = ++latestGeneration;
+    hasPendingJob = true;
+
+    if (!frameTimer.isActive())
+    {
+        frameTimer.start();
+    }
+}
+
+
+
+void PreviewRefresher::startRender()
+{
+    // A render is still running; renderFinished() picks up the pending job.
+    if (!hasPendingJob || renderWatcher.isRunning())
+    {
+        return;
+    }
+
+    PreviewJob job = pendingJob;
+    hasPendingJob = false;
+    renderWatcher.setFuture(QtConcurrent::run(&PreviewRefresher::render, job));
+}
+
+
+
+void PreviewRefresher::renderFinished()
+{
+    PreviewResult result = renderWatcher.result();
+
+    if (result.generation == latestGeneration)
+    {
+        emit previewReady(result.paletteImage);
+    }
+
+    if (hasPendingJob && !frameTimer.isActive())
+    {
+        frameTimer.start();
+    }
+}
+
+
+
+PreviewRefresher::PreviewResult PreviewRefresher::render(const PreviewJob &job)
+{
+    PreviewResult result;
+    result.generation = job.generation;
+    result.paletteImage = PaletteEngine::getImageFromBin(job.paletteData, job.settings);
+    return result;
+}
@@ -0,0 +1,59 @@
+#ifndef PREVIEWREFRESHER_H
+#define PREVIEWREFRESHER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QTimer>
+
+#include "paletteengine.h"
+
+// Renders palette previews off the GUI thread.
+//
+// Requests are coalesced to at most one per frame: only the newest request
+// made within a frame is rendered, and a request that arrives while a
+// render is running replaces any pending one. Results of renders that were
+// overtaken by newer requests are dropped instead of being shown.
+class PreviewRefresher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PreviewRefresher(QObject *parent = nullptr);
+    ~PreviewRefresher();
+
+    void request(const QByteArray &paletteData, const PaletteSettings &settings);
+
+signals:
+    void previewReady(const QImage &paletteImage);
+
+private slots:
+    void startRender();
+    void renderFinished();
+
+private:
+    struct PreviewJob
+    {
+        QByteArray paletteData;
+        PaletteSettings settings;
+        quint64 generation = 0;
+    };
+
+    struct PreviewResult
+    {
+        QImage paletteImage;
+        quint64 generation = 0;
+    };
+
+    static PreviewResult render(const PreviewJob &job);
+
+    QTimer frameTimer;
+    QFutureWatcher<PreviewResult> renderWatcher;
+
+    PreviewJob pendingJob;
+    bool hasPendingJob;
+    quint64 latestGeneration;
+};
+
+#endif // PREVIEWREFRESHER_H
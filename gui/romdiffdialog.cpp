@@ -0,0 +1,203 @@
+#include "romdiffdialog.h"
+
+#include <QDialogButtonBox>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+RomDiffDialog::RomDiffDialog(const PaletteEngine &paletteEngine, quint32 paletteRowWidth, QWidget *parent)
+    : QDialog(parent)
+    , engine(paletteEngine)
+    , compareTime(0)
+    , rowWidth(paletteRowWidth)
+{
+    setWindowTitle(tr("Compare ROMs"));
+    resize(560, 480);
+
+    summaryLabel = new QLabel(this);
+    summaryLabel->setWordWrap(true);
+
+    palettesOnlyCheckBox = new QCheckBox(tr("Palette-like ranges only"), this);
+    palettesOnlyCheckBox->setChecked(true);
+
+    rangeList = new QListWidget(this);
+    rangeList->setMaximumHeight(160);
+
+    preview = new PalettePreviewWidget(this);
+    preview->setToolTip(tr("Left: compared ROM, right: loaded ROM"));
+
+    QPushButton *exportButton = new QPushButton(tr("Export Report..."), this);
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    buttonBox->addButton(exportButton, QDialogButtonBox::ActionRole);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(summaryLabel);
+    layout->addWidget(palettesOnlyCheckBox);
+    layout->addWidget(rangeList);
+    layout->addWidget(preview, 1);
+    layout->addWidget(buttonBox);
+
+    connect(palettesOnlyCheckBox, &QCheckBox::toggled, this, &RomDiffDialog::updateRangeList);
+    connect(rangeList, &QListWidget::currentRowChanged, this, &RomDiffDialog::showRange);
+    connect(rangeList, &QListWidget::itemDoubleClicked, this, &RomDiffDialog::activateRange);
+    connect(exportButton, &QPushButton::clicked, this, &RomDiffDialog::exportReport);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+
+
+QString RomDiffDialog::errorString() const
+{
+    return lastError;
+}
+
+
+
+bool RomDiffDialog::compareWith(const QString &romPath)
+{
+    if (!otherRom.open(romPath))
+    {
+        lastError = otherRom.errorString();
+        return false;
+    }
+
+    QElapsedTimer compareTimer;
+    compareTimer.start();
+    ranges = RomDiff::compare(otherRom.view(0, otherRom.size()), engine.storage().view(0, engine.size()));
+    compareTime = compareTimer.elapsed();
+    otherRomName = QFileInfo(romPath).fileName();
+    return true;
+}
+
+
+
+void RomDiffDialog::showComparison()
+{
+    int paletteRanges = 0;
+    quint64 differingBytes = 0;
+
+    for (const RomDiffRange &range : std::as_const(ranges))
+    {
+        paletteRanges += range.paletteLike ? 1 : 0;
+        differingBytes += range.length;
+    }
+
+    summaryLabel->setText(tr("%1 (left) vs %2 (right): %3 ranges, %4 palette-like, %5 bytes, compared in %6 ms.")
+                              .arg(otherRomName, QFileInfo(engine.filePath()).fileName())
+                              .arg(ranges.size()).arg(paletteRanges).arg(differingBytes).arg(compareTime));
+
+    updateRangeList();
+}
+
+
+
+QString RomDiffDialog::addressText(quint32 fileOffset) const
+{
+    quint32 busAddress;
+
+    if (engine.addressMapMode() != AddressMapMode::None && engine.toBusAddress(fileOffset, busAddress))
+    {
+        return "$" + QString::number(busAddress, 16).rightJustified(6, '0').toUpper();
+    }
+
+    return "0x" + QString::number(fileOffset, 16).rightJustified(6, '0').toUpper();
+}
+
+
+
+void RomDiffDialog::updateRangeList()
+{
+    bool palettesOnly = palettesOnlyCheckBox->isChecked();
+
+    visibleRanges.clear();
+    rangeList->clear();
+
+    for (int i = 0; i < ranges.size(); i++)
+    {
+        const RomDiffRange &range = ranges.at(i);
+
+        if (palettesOnly && !range.paletteLike)
+        {
+            continue;
+        }
+
+        visibleRanges.append(i);
+        rangeList->addItem(QString("%1  (%2 bytes%3)").arg(addressText(range.offset)).arg(range.length)
+                               .arg(range.paletteLike ? ", palette" : ""));
+    }
+
+    if (visibleRanges.isEmpty())
+    {
+        preview->setImage(QImage());
+    }
+    else
+    {
+        rangeList->setCurrentRow(0);
+    }
+}
+
+
+
+void RomDiffDialog::showRange(int row)
+{
+    if (row < 0 || row >= visibleRanges.size())
+    {
+        return;
+    }
+
+    preview->setImage(RomDiff::renderRange(otherRom.view(0, otherRom.size()), engine.storage().view(0, engine.size()),
+                                           ranges.at(visibleRanges.at(row)), rowWidth));
+}
+
+
+
+void RomDiffDialog::activateRange(QListWidgetItem *item)
+{
+    int row = rangeList->row(item);
+
+    if (row < 0 || row >= visibleRanges.size())
+    {
+        return;
+    }
+
+    const RomDiffRange &range = ranges.at(visibleRanges.at(row));
+
+    if (range.offset >= engine.size())
+    {
+        return;
+    }
+
+    quint32 length = qMin(range.length, engine.size() - range.offset);
+    emit rangeActivated(range.offset, qMax<quint32>(length / 2, 1));
+}
+
+
+
+void RomDiffDialog::exportReport()
+{
+    QString reportPath = QFileDialog::getSaveFileName(this, tr("Export Diff Report"), QFileInfo(engine.filePath()).path(), tr("CSV (*.csv)"));
+
+    if (reportPath.isEmpty())
+    {
+        return;
+    }
+
+    QFile reportFile(reportPath);
+    QString reportError;
+
+    if (!reportFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        QMessageBox::warning(this, "Warning", "Failed to create the report file.");
+        return;
+    }
+
+    if (!RomDiff::writeReport(&reportFile, otherRom.view(0, otherRom.size()), engine.storage().view(0, engine.size()),
+                              ranges, engine.addressMapper(), reportError))
+    {
+        QMessageBox::warning(this, "Warning", reportError);
+    }
+}
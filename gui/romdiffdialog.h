@@ -0,0 +1,61 @@
+#ifndef ROMDIFFDIALOG_H
+#define ROMDIFFDIALOG_H
+
+#include <QCheckBox>
+#include <QDialog>
+#include <QLabel>
+#include <QListWidget>
+
+#include "paletteengine.h"
+#include "palettepreviewwidget.h"
+#include "romdiff.h"
+#include "romstorage.h"
+
+// Compares another ROM (left, "before") with the engine's loaded ROM
+// (right, "after") and lists the differing ranges. Selecting a range shows
+// both versions as palette strips side by side; double clicking it asks the
+// main window to load that range into the editor. Meant to be run modally
+// so the loaded ROM cannot change underneath the results.
+//
+// compareWith() does the file I/O and touches no widgets, so it may run on
+// a worker as long as the engine is left alone; showComparison() then
+// fills in the dialog on the GUI thread.
+class RomDiffDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    RomDiffDialog(const PaletteEngine &paletteEngine, quint32 paletteRowWidth, QWidget *parent = nullptr);
+
+    bool compareWith(const QString &romPath);
+    void showComparison();
+    QString errorString() const;
+
+signals:
+    void rangeActivated(quint32 fileOffset, quint32 colorCount);
+
+private slots:
+    void updateRangeList();
+    void showRange(int row);
+    void activateRange(QListWidgetItem *item);
+    void exportReport();
+
+private:
+    const PaletteEngine &engine;
+    RomStorage otherRom;
+    QList<RomDiffRange> ranges;
+    QList<int> visibleRanges;
+    QString otherRomName;
+    qint64 compareTime;
+    quint32 rowWidth;
+    QString lastError;
+
+    QLabel *summaryLabel;
+    QCheckBox *palettesOnlyCheckBox;
+    QListWidget *rangeList;
+    PalettePreviewWidget *preview;
+
+    QString addressText(quint32 fileOffset) const;
+};
+
+#endif // ROMDIFFDIALOG_H
@@ -0,0 +1,186 @@
+#include "romfileworker.h"
+
+#include <QtConcurrent>
+
+static void loadRom(QPromise<void> &promise, PaletteEngine *engine)
+{
+    promise.setProgressRange(0, int(engine->size() / 1024));
+
+    while (!promise.isCanceled() && engine->loadRomChunk() > 0)
+    {
+        promise.setProgressValue(int(engine->loadedSize() / 1024));
+    }
+
+    // The window needs the checksum sum for its first save; keep it off
+    // its thread.
+    if (!promise.isCanceled())
+    {
+        engine->prepareRomSums();
+    }
+}
+
+
+
+static void saveRom(QPromise<QString> &promise, const RomSaveJob &job, qint64 totalBytes)
+{
+    QString errorString;
+
+    promise.setProgressRange(0, int(totalBytes / 1024));
+
+    bool saved = PaletteEngine::writeRomFile(job, errorString, [&promise](qint64 written, qint64)
+    {
+        promise.setProgressValue(int(written / 1024));
+        return !promise.isCanceled();
+    });
+
+    promise.addResult(saved ? QString() : errorString);
+}
+
+
+
+RomFileWorker::RomFileWorker(PaletteEngine &paletteEngine, QObject *parent)
+    : QObject(parent)
+    , engine(paletteEngine)
+    , totalBytes(0)
+{
+    connect(&loadWatcher, &QFutureWatcher<void>::finished, this, &RomFileWorker::loadDone);
+    connect(&loadWatcher, &QFutureWatcher<void>::progressValueChanged, this, &RomFileWorker::reportProgress);
+    connect(&saveWatcher, &QFutureWatcher<QString>::finished, this, &RomFileWorker::saveDone);
+    connect(&saveWatcher, &QFutureWatcher<QString>::progressValueChanged, this, &RomFileWorker::reportProgress);
+    connect(&taskWatcher, &QFutureWatcher<TaskResult>::finished, this, &RomFileWorker::taskDone);
+}
+
+RomFileWorker::~RomFileWorker()
+{
+    // A load is pointless once the window is gone; a save is allowed to
+    // finish so the file on disk ends up complete.
+    loadWatcher.cancel();
+    loadWatcher.waitForFinished();
+    saveWatcher.waitForFinished();
+    taskWatcher.waitForFinished();
+}
+
+
+
+bool RomFileWorker::isBusy() const
+{
+    return loadWatcher.isRunning() || saveWatcher.isRunning() || taskWatcher.isRunning();
+}
+
+
+
+bool RomFileWorker::startLoad(const QString &romPath, const QStringList &patchPaths)
+{
+    if (isBusy() || !engine.beginOpenRom(romPath, patchPaths))
+    {
+        return false;
+    }
+
+    totalBytes = engine.size();
+    loadWatcher.setFuture(QtConcurrent::run(loadRom, &engine));
+    return true;
+}
+
+
+
+bool RomFileWorker::startSave(const QString &romPath)
+{
+    if (isBusy() || !engine.prepareSave(romPath, saveJob))
+    {
+        return false;
+    }
+
+    totalBytes = 0;
+
+    if (saveJob.wholeFile)
+    {
+        totalBytes = saveJob.romData.size();
+    }
+    else
+    {
+        for (const ByteRange &range : std::as_const(saveJob.ranges))
+        {
+            totalBytes += range.length;
+        }
+    }
+
+    saveWatcher.setFuture(QtConcurrent::run(saveRom, saveJob, totalBytes));
+    return true;
+}
+
+
+
+bool RomFileWorker::startTask(const std::function<bool(QString &message)> &task)
+{
+    if (isBusy())
+    {
+        return false;
+    }
+
+    taskWatcher.setFuture(QtConcurrent::run([task]
+    {
+        TaskResult result;
+        result.ok = task(result.message);
+        return result;
+    }));
+
+    return true;
+}
+
+
+
+void RomFileWorker::cancel()
+{
+    loadWatcher.cancel();
+    saveWatcher.cancel();
+}
+
+
+
+void RomFileWorker::reportProgress(int kilobytes)
+{
+    emit progress(qMin(qint64(kilobytes) * 1024, totalBytes), totalBytes);
+}
+
+
+
+void RomFileWorker::loadDone()
+{
+    if (loadWatcher.isCanceled())
+    {
+        engine.closeRom();
+        emit loadFinished(false, "Loading was canceled.");
+        return;
+    }
+
+    bool loaded = engine.finishOpenRom();
+    emit loadFinished(loaded, loaded ? QString() : engine.errorString());
+}
+
+
+
+void RomFileWorker::saveDone()
+{
+    QString errorString = "Saving was canceled.";
+
+    if (!saveWatcher.isCanceled() && saveWatcher.future().resultCount() > 0)
+    {
+        errorString = saveWatcher.result();
+    }
+
+    if (errorString.isEmpty())
+    {
+        engine.commitSave(saveJob);
+    }
+
+    saveJob = RomSaveJob();
+    emit saveFinished(errorString.isEmpty(), errorString);
+}
+
+
+
+void RomFileWorker::taskDone()
+{
+    const TaskResult result = taskWatcher.result();
+    emit taskFinished(result.ok, result.message);
+}
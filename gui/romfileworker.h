@@ -0,0 +1,74 @@
+#ifndef ROMFILEWORKER_H
+#define ROMFILEWORKER_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+#include "paletteengine.h"
+
+// Loads and saves the engine's ROM, and runs the engine's other file
+// operations, on the thread pool.
+//
+// Only the file I/O leaves the GUI thread: the engine's begin/prepare and
+// finish/commit steps run here, in startLoad()/startSave() and when the
+// worker is done. While loading, the ROM is readable front to back as
+// chunks arrive (progress() is the cue to retry a preview); editing and
+// saving must wait for loadFinished(). While saving the ROM must not be
+// edited. cancel() stops either at the next chunk: a canceled load closes
+// the ROM, a canceled full save leaves the old file untouched.
+//
+// startTask() runs any other operation that reads or writes files (bulk
+// extracts, patch export, manifest import, opening a ROM to compare). The
+// task gets the message to report and returns whether it succeeded; it
+// may use the engine freely, so the window must leave the engine alone
+// until taskFinished().
+class RomFileWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RomFileWorker(PaletteEngine &paletteEngine, QObject *parent = nullptr);
+    ~RomFileWorker();
+
+    bool isBusy() const;
+
+    // Both return false when the worker is busy or the engine refuses to
+    // start, with the reason in the engine's errorString().
+    bool startLoad(const QString &romPath, const QStringList &patchPaths);
+    bool startSave(const QString &romPath);
+    bool startTask(const std::function<bool(QString &message)> &task);
+
+    void cancel();
+
+signals:
+    void progress(qint64 done, qint64 total);
+    void loadFinished(bool ok, const QString &errorString);
+    void saveFinished(bool ok, const QString &errorString);
+    void taskFinished(bool ok, const QString &message);
+
+private slots:
+    void loadDone();
+    void saveDone();
+    void taskDone();
+    void reportProgress(int kilobytes);
+
+private:
+    struct TaskResult
+    {
+        bool ok = false;
+        QString message;
+    };
+
+    PaletteEngine &engine;
+    QFutureWatcher<void> loadWatcher;
+    QFutureWatcher<QString> saveWatcher;
+    QFutureWatcher<TaskResult> taskWatcher;
+    RomSaveJob saveJob;
+    qint64 totalBytes;
+};
+
+#endif // ROMFILEWORKER_H
@@ -0,0 +1,14 @@
+# Checks for the spicore library: patch round trips and checksum sums.
+
+QT       = core gui concurrent testlib
+
+TEMPLATE = app
+CONFIG += console testcase c++17
+CONFIG -= app_bundle
+
+TARGET = tst_core
+
+include(../../core/spicore.pri)
+
+SOURCES += \
+    tst_core.cpp
@@ -0,0 +1,403 @@
+#include <QBuffer>
+#include <QRandomGenerator>
+#include <QtEndian>
+#include <QtTest>
+
+#include "byterangeset.h"
+#include "crc32.h"
+#include "rompatch.h"
+#include "romstorage.h"
+#include "sneschecksum.h"
+
+Q_DECLARE_METATYPE(ByteRange)
+
+class TestCore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void ipsRoundTrip_data();
+    void ipsRoundTrip();
+    void bpsRoundTrip_data();
+    void bpsRoundTrip();
+    void bpsRejectsSourceMismatch();
+    void bpsRejectsTargetMismatch();
+    void checksumMirroring_data();
+    void checksumMirroring();
+    void incrementalChecksum_data();
+    void incrementalChecksum();
+};
+
+
+
+static QByteArray randomBytes(qsizetype size, quint32 seed)
+{
+    QRandomGenerator generator(seed);
+    QList<quint32> words((size + 3) / 4);
+
+    generator.fillRange(words.data(), words.size());
+    return QByteArray(reinterpret_cast<const char *>(words.constData()), size);
+}
+
+
+
+// Copy of source resized to targetSize, with every byte inside edits
+// changed. New bytes outside edits are zero.
+static QByteArray editedTarget(const QByteArray &source, qsizetype targetSize, const QList<ByteRange> &edits)
+{
+    QByteArray target = source.first(qMin(source.size(), targetSize));
+    target.append(QByteArray(targetSize - target.size(), '\0'));
+
+    for (const ByteRange &edit : edits)
+    {
+        for (qsizetype i = edit.offset; i < edit.end(); i++)
+        {
+            target[i] = i < source.size() ? char(~source[i]) : char(i);
+        }
+    }
+
+    return target;
+}
+
+
+
+static ByteRangeSet rangeSet(const QList<ByteRange> &edits)
+{
+    ByteRangeSet ranges;
+
+    for (const ByteRange &edit : edits)
+    {
+        ranges.add(edit.offset, edit.length);
+    }
+
+    return ranges;
+}
+
+
+
+// Expands data to a power of two the way the header checksum counts it:
+// the largest power of two that fits, then the rest expanded the same way
+// and repeated until it is as large.
+static QByteArray mirroredImage(const QByteArray &data)
+{
+    qsizetype part = 1;
+
+    while (part * 2 <= data.size())
+    {
+        part *= 2;
+    }
+
+    if (part == data.size())
+    {
+        return data;
+    }
+
+    const QByteArray rest = mirroredImage(data.sliced(part));
+    QByteArray image = data.first(part);
+
+    while (image.size() < part * 2)
+    {
+        image += rest;
+    }
+
+    return image;
+}
+
+static quint16 referenceChecksum(const QByteArray &data, qsizetype copierHeader)
+{
+    const QByteArray image = mirroredImage(data.sliced(copierHeader));
+    quint32 sum = 0;
+
+    for (char byte : image)
+    {
+        sum += uchar(byte);
+    }
+
+    return quint16(sum);
+}
+
+
+
+static bool applyPatch(const QByteArray &patch, RomStorage &rom, ByteRangeSet &changedRanges, QString &errorString)
+{
+    QBuffer buffer;
+    buffer.setData(patch);
+    buffer.open(QIODevice::ReadOnly);
+
+    return RomPatch::apply(&buffer, rom, changedRanges, errorString);
+}
+
+
+
+void TestCore::ipsRoundTrip_data()
+{
+    QTest::addColumn<int>("sourceSize");
+    QTest::addColumn<int>("targetSize");
+    QTest::addColumn<QList<ByteRange>>("edits");
+
+    QTest::newRow("start and end") << 0x8000 << 0x8000
+                                   << QList<ByteRange> { { 0, 16 }, { 0x7FF0, 16 } };
+
+    // Records longer than 0xFFFF bytes are split.
+    QTest::newRow("long record") << 0x40000 << 0x40000
+                                 << QList<ByteRange> { { 0x100, 0x2FFFF } };
+
+    QTest::newRow("grow") << 0x8000 << 0x8100
+                          << QList<ByteRange> { { 0x7F00, 0x200 } };
+
+    // A record may not start at 0x454F46, which reads as "EOF".
+    QTest::newRow("EOF offset") << 0x500000 << 0x500000
+                                << QList<ByteRange> { { 0x454F46, 3 } };
+
+    QTest::newRow("EOF offset after split") << 0x500000 << 0x500000
+                                            << QList<ByteRange> { { 0x454F46 - 0xFFFF, 0x20000 } };
+}
+
+void TestCore::ipsRoundTrip()
+{
+    QFETCH(int, sourceSize);
+    QFETCH(int, targetSize);
+    QFETCH(QList<ByteRange>, edits);
+
+    const QByteArray source = randomBytes(sourceSize, 1);
+    const QByteArray target = editedTarget(source, targetSize, edits);
+    QString errorString;
+
+    QByteArray patch;
+    QBuffer buffer(&patch);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY2(RomPatch::writeIps(&buffer, target, rangeSet(edits), errorString), qPrintable(errorString));
+    buffer.close();
+
+    RomStorage rom;
+    rom.setContents(source);
+    ByteRangeSet changedRanges;
+
+    QVERIFY2(applyPatch(patch, rom, changedRanges, errorString), qPrintable(errorString));
+    QCOMPARE(rom.size(), target.size());
+    QVERIFY(rom.view(0, rom.size()).toByteArray() == target);
+
+    for (const ByteRange &edit : edits)
+    {
+        QVERIFY(changedRanges.intersects(edit.offset, edit.length));
+    }
+}
+
+
+
+void TestCore::bpsRoundTrip_data()
+{
+    QTest::addColumn<int>("sourceSize");
+    QTest::addColumn<int>("targetSize");
+    QTest::addColumn<QList<ByteRange>>("edits");
+
+    QTest::newRow("unchanged") << 0x8000 << 0x8000 << QList<ByteRange>();
+
+    QTest::newRow("scattered") << 0x100000 << 0x100000
+                               << QList<ByteRange> { { 0, 1 }, { 0x7FC0, 0x40 }, { 0x12345, 0x80 }, { 0xFFFFF, 1 } };
+
+    QTest::newRow("grow") << 0x8000 << 0x10000
+                          << QList<ByteRange> { { 0x100, 0x20 }, { 0x9000, 0x100 } };
+
+    QTest::newRow("shrink") << 0x10000 << 0x8000
+                            << QList<ByteRange> { { 0x7000, 0x1000 } };
+}
+
+void TestCore::bpsRoundTrip()
+{
+    QFETCH(int, sourceSize);
+    QFETCH(int, targetSize);
+    QFETCH(QList<ByteRange>, edits);
+
+    const QByteArray source = randomBytes(sourceSize, 2);
+    const QByteArray target = editedTarget(source, targetSize, edits);
+    QString errorString;
+
+    QByteArray patch;
+    QBuffer buffer(&patch);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY2(RomPatch::writeBps(&buffer, source.size(), crc32(source), target, rangeSet(edits), errorString),
+             qPrintable(errorString));
+    buffer.close();
+
+    RomStorage rom;
+    rom.setContents(source);
+    ByteRangeSet changedRanges;
+
+    QVERIFY2(applyPatch(patch, rom, changedRanges, errorString), qPrintable(errorString));
+    QCOMPARE(rom.size(), target.size());
+    QVERIFY(rom.view(0, rom.size()).toByteArray() == target);
+
+    for (const ByteRange &edit : edits)
+    {
+        QVERIFY(changedRanges.intersects(edit.offset, edit.length));
+    }
+}
+
+
+
+void TestCore::bpsRejectsSourceMismatch()
+{
+    const QByteArray source = randomBytes(0x8000, 3);
+    const QList<ByteRange> edits { { 0x100, 0x10 } };
+    const QByteArray target = editedTarget(source, source.size(), edits);
+    QString errorString;
+
+    QByteArray patch;
+    QBuffer buffer(&patch);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(RomPatch::writeBps(&buffer, source.size(), crc32(source), target, rangeSet(edits), errorString));
+    buffer.close();
+
+    QByteArray otherSource = source;
+    otherSource[0x4000] = char(~otherSource[0x4000]);
+
+    RomStorage rom;
+    rom.setContents(otherSource);
+    ByteRangeSet changedRanges;
+
+    QVERIFY(!applyPatch(patch, rom, changedRanges, errorString));
+    QVERIFY(errorString.contains("source checksum"));
+    QVERIFY(rom.view(0, rom.size()).toByteArray() == otherSource);
+    QVERIFY(changedRanges.isEmpty());
+}
+
+
+
+// The target CRC is changed and the patch CRC fixed up to match, so only
+// the target check can catch it.
+void TestCore::bpsRejectsTargetMismatch()
+{
+    const QByteArray source = randomBytes(0x8000, 4);
+    const QList<ByteRange> edits { { 0x100, 0x10 } };
+    const QByteArray target = editedTarget(source, source.size(), edits);
+    QString errorString;
+
+    QByteArray patch;
+    QBuffer buffer(&patch);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(RomPatch::writeBps(&buffer, source.size(), crc32(source), target, rangeSet(edits), errorString));
+    buffer.close();
+
+    const qsizetype footer = patch.size() - 12;
+    qToLittleEndian<quint32>(crc32(target) ^ 1, patch.data() + footer + 4);
+    qToLittleEndian<quint32>(crc32(QByteArrayView(patch).first(footer + 8)), patch.data() + footer + 8);
+
+    RomStorage rom;
+    rom.setContents(source);
+    ByteRangeSet changedRanges;
+
+    QVERIFY(!applyPatch(patch, rom, changedRanges, errorString));
+    QCOMPARE(errorString, QString("BPS patch failed its checksum check."));
+    QVERIFY(rom.view(0, rom.size()).toByteArray() == source);
+}
+
+
+
+void TestCore::checksumMirroring_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("copierHeader");
+    QTest::addColumn<int>("mode");
+
+    QTest::newRow("2 MB LoROM") << 0x200000 << 0 << int(AddressMapMode::LoRom);
+    QTest::newRow("2.5 MB LoROM") << 0x280000 << 0 << int(AddressMapMode::LoRom);
+    QTest::newRow("3 MB HiROM") << 0x300000 << 0 << int(AddressMapMode::HiRom);
+    QTest::newRow("6 MB ExHiROM") << 0x600000 << 0 << int(AddressMapMode::ExHiRom);
+    QTest::newRow("6 MB ExHiROM with copier header") << 0x600200 << 0x200 << int(AddressMapMode::ExHiRom);
+    QTest::newRow("uneven size") << 0x2E8000 << 0 << int(AddressMapMode::LoRom);
+}
+
+// The header is given a field with the computed checksum, which has to
+// match a plain sum over the mirrored image.
+void TestCore::checksumMirroring()
+{
+    QFETCH(int, size);
+    QFETCH(int, copierHeader);
+    QFETCH(int, mode);
+
+    QByteArray data = randomBytes(size, 5);
+    SnesChecksum checksum;
+    checksum.reset(size, copierHeader);
+    checksum.add(0, data);
+
+    const qsizetype headerOffset = checksum.headerOffset(AddressMapMode(mode), data);
+    QVERIFY(headerOffset >= 0);
+
+    const quint16 value = checksum.checksum(data, headerOffset);
+    data.replace(headerOffset + SnesChecksum::fieldOffset, SnesChecksum::fieldSize, SnesChecksum::checksumField(value));
+
+    QCOMPARE(value, referenceChecksum(data, copierHeader));
+    QCOMPARE(SnesChecksum::storedChecksum(data, headerOffset), value);
+}
+
+
+
+void TestCore::incrementalChecksum_data()
+{
+    checksumMirroring_data();
+}
+
+// Loads in chunks, makes random edits through replace() and checks the
+// running sum against a fresh one, then writes the field the way a save
+// does and checks it against the mirrored image.
+void TestCore::incrementalChecksum()
+{
+    QFETCH(int, size);
+    QFETCH(int, copierHeader);
+    QFETCH(int, mode);
+
+    const qsizetype chunkSize = 0x18000;
+    QByteArray data = randomBytes(size, 6);
+    SnesChecksum checksum;
+    checksum.reset(size, copierHeader);
+
+    for (qsizetype offset = 0; offset < data.size(); offset += chunkSize)
+    {
+        checksum.add(offset, QByteArrayView(data).sliced(offset, qMin(chunkSize, data.size() - offset)));
+    }
+
+    const qsizetype headerOffset = checksum.headerOffset(AddressMapMode(mode), data);
+    QVERIFY(headerOffset >= 0);
+
+    QRandomGenerator generator(size);
+
+    for (int edit = 1; edit <= 1000; edit++)
+    {
+        const int length = 1 + generator.bounded(64);
+        const int offset = generator.bounded(size - length + 1);
+        const QByteArray before = data.mid(offset, length);
+
+        for (int i = offset; i < offset + length; i++)
+        {
+            data[i] = char(generator.bounded(256));
+        }
+
+        checksum.replace(offset, before, QByteArrayView(data).sliced(offset, length));
+
+        if (edit % 250 == 0)
+        {
+            SnesChecksum fresh;
+            fresh.reset(size, copierHeader);
+            fresh.add(0, data);
+
+            QCOMPARE(checksum.checksum(data, headerOffset), fresh.checksum(data, headerOffset));
+        }
+    }
+
+    const qsizetype fieldOffset = headerOffset + SnesChecksum::fieldOffset;
+    const QByteArray before = data.mid(fieldOffset, SnesChecksum::fieldSize);
+    const quint16 value = checksum.checksum(data, headerOffset);
+
+    data.replace(fieldOffset, SnesChecksum::fieldSize, SnesChecksum::checksumField(value));
+    checksum.replace(fieldOffset, before, QByteArrayView(data).sliced(fieldOffset, SnesChecksum::fieldSize));
+
+    QCOMPARE(value, referenceChecksum(data, copierHeader));
+    QCOMPARE(checksum.checksum(data, headerOffset), value);
+}
+
+
+
+QTEST_APPLESS_MAIN(TestCore)
+
+#include "tst_core.moc"
@@ -0,0 +1,6 @@
+# QtTest checks for the palette engine. Run them with "make check".
+
+TEMPLATE = subdirs
+
+SUBDIRS = \
+    core